@@ -0,0 +1,72 @@
+#include "Benchmarks.h"
+
+namespace Benchmarks
+{
+    double secondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    juce::File writeTestImpulseResponse(double seconds, double sampleRate)
+    {
+        auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                        .getChildFile("RetroizerBenchmarkIR_" + juce::String(seconds) + ".wav");
+
+        juce::AudioBuffer<float> impulse(1, juce::jmax(1, (int)(seconds * sampleRate)));
+        juce::Random random(1234);
+
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            impulse.setSample(0, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-6.0f * (float)i / (float)impulse.getNumSamples()));
+
+        file.deleteFile();
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(new juce::FileOutputStream(file), sampleRate, 1, 24, {}, 0));
+
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer(impulse, 0, impulse.getNumSamples());
+
+        return file;
+    }
+
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    void setParameter(RetroizerAudioProcessor& processor, Parameters::ID id, float normalisedValue)
+    {
+        processor.apvts.getParameter(Parameters::idOf(id))->setValueNotifyingHost(normalisedValue);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree and the convolution loader expect JUCE to be initialised
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const std::pair<const char*, void (*)()> benchmarks[] = {
+        { "convolution", Benchmarks::runConvolution },
+        { "startup",     Benchmarks::runStartup },
+        { "blocksizes",  Benchmarks::runBlockSizes },
+        { "lanes",       Benchmarks::runLanes },
+    };
+
+    juce::StringArray selected;
+
+    for (int i = 1; i < argc; ++i)
+        selected.add(argv[i]);
+
+    for (const auto& [name, run] : benchmarks)
+    {
+        if (selected.isEmpty() || selected.contains(name))
+        {
+            std::printf("== %s ==\n", name);
+            run();
+            std::printf("\n");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+// Console benchmarks for the processor and its DSP. Each one prints a small table to
+// stdout; run RetroizerBenchmarks with no arguments for all of them, or name the ones to run.
+namespace Benchmarks
+{
+    void runConvolution();
+    void runStartup();
+    void runBlockSizes();
+    void runLanes();
+
+    // Shared helpers
+    double secondsSince(juce::int64 startTicks);
+
+    // Writes a decaying noise burst to a temporary WAV file for the convolution stage
+    juce::File writeTestImpulseResponse(double seconds, double sampleRate);
+
+    // Fills a buffer with deterministic full-scale noise
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random);
+
+    void setParameter(RetroizerAudioProcessor& processor, Parameters::ID id, float normalisedValue);
+}
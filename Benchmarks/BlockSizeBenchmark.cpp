@@ -0,0 +1,51 @@
+#include "Benchmarks.h"
+
+// Cost per sample of the whole processor at the host block sizes it has to cope with,
+// from single samples to very large buffers, including odd sizes that straddle the
+// internal processing grid. The per-sample cost should stay roughly flat.
+void Benchmarks::runBlockSizes()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr double secondsToProcess = 5.0;
+
+    std::printf("grid: %d samples\n", ProcessingGrid::controlInterval);
+    std::printf("%-10s %12s %14s\n", "block", "ns/sample", "x real time");
+
+    for (int blockSize : { 1, 2, 3, 17, 63, 64, 65, 127, 511, 1024, 4096, 8192 })
+    {
+        RetroizerAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        // Every stage busy: crushing, both band-passes, noise and envelope modulation
+        using Parameters::ID;
+        setParameter(processor, ID::bitDepth, 0.6f);
+        setParameter(processor, ID::sampleRate, 0.2f);
+        setParameter(processor, ID::radioMix1, 0.8f);
+        setParameter(processor, ID::radioMix2, 0.5f);
+        setParameter(processor, ID::noiseStatic, 0.3f);
+        setParameter(processor, ID::noiseCrackle, 0.3f);
+        setParameter(processor, ID::noiseHum, 0.3f);
+        setParameter(processor, ID::envToBitDepth, 0.75f);
+        setParameter(processor, ID::adaptiveQuality, 0.0f);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(7);
+
+        int numBlocks = juce::jmax(1, (int)(secondsToProcess * sampleRate) / blockSize);
+        double elapsed = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillWithNoise(buffer, random);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock(buffer, midi);
+            elapsed += secondsSince(start);
+        }
+
+        double samples = (double)numBlocks * blockSize;
+        std::printf("%-10d %12.1f %14.1f\n", blockSize, elapsed * 1.0e9 / samples, samples / sampleRate / elapsed);
+    }
+}
@@ -0,0 +1,64 @@
+#include "Benchmarks.h"
+#include "../Source/RadioEffect.h"
+
+// Cost of the first radio stage against impulse response length, at the engine's fixed
+// internal block size. The band-pass row is the baseline the convolution replaces.
+void Benchmarks::runConvolution()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    constexpr double secondsToProcess = 10.0;
+
+    std::printf("%-10s %12s %14s\n", "IR", "ns/sample", "x real time");
+
+    for (double seconds : { 0.0, 0.1, 0.25, 0.5, 1.0, 2.0 })
+    {
+        auto label = seconds > 0.0 ? juce::String(seconds, 2) + " s" : juce::String("band-pass");
+
+        RadioEffect effect;
+        effect.prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+        effect.setMix1(0, 1.0f);
+        effect.setMix1(1, 1.0f);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::Random random(42);
+
+        if (seconds > 0.0)
+        {
+            effect.setMode(RadioEffect::Mode::convolution);
+            effect.loadImpulseResponse(writeTestImpulseResponse(seconds, sampleRate));
+
+            // The IR is prepared in the background and swapped in while processing
+            auto waitStart = juce::Time::getHighResolutionTicks();
+            auto loaded = [&] { return effect.getImpulseResponseSize() > (int)(seconds * sampleRate) / 2; };
+
+            while (! loaded() && secondsSince(waitStart) < 10.0)
+            {
+                buffer.clear();
+                effect.process(buffer.getArrayOfWritePointers(), 2, blockSize);
+                juce::Thread::sleep(1);
+            }
+
+            if (! loaded())
+            {
+                std::printf("%-10s %12s\n", label.toRawUTF8(), "IR not loaded");
+                continue;
+            }
+        }
+
+        int numBlocks = (int)(secondsToProcess * sampleRate) / blockSize;
+        double elapsed = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillWithNoise(buffer, random);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            effect.process(buffer.getArrayOfWritePointers(), 2, blockSize);
+            elapsed += secondsSince(start);
+        }
+
+        double samples = (double)numBlocks * blockSize;
+        std::printf("%-10s %12.1f %14.1f\n", label.toRawUTF8(), elapsed * 1.0e9 / samples, samples / sampleRate / elapsed);
+    }
+}
@@ -0,0 +1,83 @@
+#include "Benchmarks.h"
+
+// Processing a channel pair together against running each channel on its own: the
+// crusher's pair loop against DSPCore::crushLane once per channel, and the radio band-pass
+// with left and right in two SIMD lanes against two scalar biquads. Both sides run on the
+// same noise, one control interval at a time like the processor.
+void Benchmarks::runLanes()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int interval = ProcessingGrid::controlInterval;
+    constexpr int numIntervals = (int)(10.0 * sampleRate) / interval;
+
+    juce::ScopedNoDenormals noDenormals;
+    juce::AudioBuffer<float> source(2, numIntervals * interval), work(2, numIntervals * interval);
+    juce::Random random(11);
+    fillWithNoise(source, random);
+
+    // Nanoseconds per stereo frame for one pass over the noise
+    auto time = [&](auto&& processInterval)
+    {
+        work.makeCopyOf(source, true);
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numIntervals; ++i)
+        {
+            float* channels[] = { work.getWritePointer(0, i * interval), work.getWritePointer(1, i * interval) };
+            processInterval(channels);
+        }
+
+        return secondsSince(start) * 1.0e9 / (double)work.getNumSamples();
+    };
+
+    juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32)interval, 2 };
+
+    // Crusher without rate reduction, where the pair loop applies
+    BitCrusher crusher;
+    crusher.prepare(spec);
+
+    for (int channel = 0; channel < BitCrusher::maxChannels; ++channel)
+    {
+        crusher.setBitDepth(channel, 0.6f);
+        crusher.setSampleRateReduction(channel, 0.0f);
+    }
+
+    DSPCore::Quantizer quantizer;
+    quantizer.setBits(DSPCore::bitsFromParameter(0.6f));
+    DSPCore::HoldState holds[2];
+
+    double crusherPaired = time([&](float* const* channels) { crusher.process(channels, 2, interval); });
+    double crusherSingle = time([&](float* const* channels)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            DSPCore::crushLane(channels[channel], 1, interval, 1, quantizer, holds[channel]);
+    });
+
+    // Second radio band-pass only, fully wet
+    RadioEffect radio;
+    radio.prepare(spec);
+
+    for (int channel = 0; channel < RadioEffect::maxChannels; ++channel)
+        radio.setMix2(channel, 1.0f);
+
+    juce::dsp::IIR::Filter<float> filters[2];
+
+    for (auto& filter : filters)
+    {
+        auto c = DSPCore::designBandPass(sampleRate, 1200.0, 0.7);
+        filter.coefficients = new juce::dsp::IIR::Coefficients<float>(c.b0, 0.0f, c.b2, 1.0f, c.a1, c.a2);
+        filter.prepare(spec);
+    }
+
+    double filterPaired = time([&](float* const* channels) { radio.process(channels, 2, interval); });
+    double filterSingle = time([&](float* const* channels)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < interval; ++i)
+                channels[channel][i] = filters[channel].processSample(channels[channel][i]);
+    });
+
+    std::printf("%-12s %16s %18s %8s\n", "stage", "paired ns/frame", "per-channel ns/frame", "ratio");
+    std::printf("%-12s %16.2f %18.2f %8.2f\n", "crusher", crusherPaired, crusherSingle, crusherSingle / crusherPaired);
+    std::printf("%-12s %16.2f %18.2f %8.2f\n", "band-pass", filterPaired, filterSingle, filterSingle / filterPaired);
+}
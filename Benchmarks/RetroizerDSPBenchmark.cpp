@@ -0,0 +1,102 @@
+#include "../Source/Embed/RetroizerDSP.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Throughput of the embeddable DSP as a host mixer would use it: many stereo voices in
+// one arena, alternating planar and interleaved buffers, while another thread keeps
+// writing parameters. Builds without JUCE.
+// Usage: RetroizerDSPBenchmark [voices] [blocks]
+
+int main(int argc, char* argv[])
+{
+    const int numVoices = argc > 1 ? std::atoi(argv[1]) : 512;
+    const int numBlocks = argc > 2 ? std::atoi(argv[2]) : 50;
+    const int numFrames = 256;
+    const double sampleRate = 48000.0;
+
+    if (numVoices < 1 || numBlocks < 1)
+    {
+        std::printf("Usage: RetroizerDSPBenchmark [voices] [blocks]\n");
+        return 1;
+    }
+
+    // One arena for every voice, each slot rounded up to the required alignment
+    const size_t alignment = retroizer_memory_alignment();
+    const size_t slotSize = (retroizer_memory_size() + alignment - 1) / alignment * alignment;
+    std::vector<unsigned char> arena(slotSize * (size_t)numVoices + alignment);
+    auto* base = arena.data() + (alignment - reinterpret_cast<std::uintptr_t>(arena.data()) % alignment) % alignment;
+
+    std::vector<RetroizerEffect*> effects;
+
+    for (int voice = 0; voice < numVoices; ++voice)
+    {
+        auto* effect = retroizer_create(base + (size_t)voice * slotSize, slotSize);
+
+        if (effect == nullptr)
+        {
+            std::printf("retroizer_create() failed\n");
+            return 1;
+        }
+
+        retroizer_prepare(effect, sampleRate);
+        RetroizerParams params { 0.4f, 0.2f, 0.7f, 0.5f };
+        retroizer_set_params(effect, &params);
+        effects.push_back(effect);
+    }
+
+    // Sweeps every parameter of the first voice for as long as the audio loop runs
+    std::atomic<bool> stop { false };
+    std::thread writer([&stop, &effects]
+    {
+        for (float value = 0.0f; ! stop.load(std::memory_order_relaxed); value = value >= 1.0f ? 0.0f : value + 0.001f)
+        {
+            RetroizerParams params { value, value, value, value };
+            retroizer_set_params(effects[0], &params);
+        }
+    });
+
+    std::vector<float> buffer((size_t)numFrames * 2);
+    double checksum = 0.0;
+    auto startTime = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        for (int voice = 0; voice < numVoices; ++voice)
+        {
+            for (size_t i = 0; i < buffer.size(); ++i)
+                buffer[i] = (float)((i * 37 + (size_t)block) % 200) * 0.01f - 1.0f;
+
+            if (voice % 2 != 0)
+            {
+                retroizer_process_interleaved(effects[(size_t)voice], buffer.data(), 2, numFrames);
+            }
+            else
+            {
+                float* channels[] = { buffer.data(), buffer.data() + numFrames };
+                retroizer_process_planar(effects[(size_t)voice], channels, 2, numFrames);
+            }
+
+            checksum += buffer[7];
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    stop = true;
+    writer.join();
+
+    for (auto* effect : effects)
+        retroizer_destroy(effect);
+
+    double audioSeconds = (double)numBlocks * numFrames / sampleRate * numVoices;
+    std::printf("%d stereo voices, %d blocks of %d frames: %.1fx real time on one core (checksum %f)\n",
+                numVoices, numBlocks, numFrames, audioSeconds / seconds, checksum);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "Benchmarks.h"
+
+namespace
+{
+    // Resident memory and thread count of this process, read from /proc where available
+    struct ProcessStats
+    {
+        double residentMB = 0.0;
+        int threads = 0;
+    };
+
+    ProcessStats readProcessStats()
+    {
+        ProcessStats stats;
+
+        for (auto& line : juce::StringArray::fromLines(juce::File("/proc/self/status").loadFileAsString()))
+        {
+            if (line.startsWith("VmRSS:"))
+                stats.residentMB = line.fromFirstOccurrenceOf(":", false, false).trim().getDoubleValue() / 1024.0;
+            else if (line.startsWith("Threads:"))
+                stats.threads = line.fromFirstOccurrenceOf(":", false, false).trim().getIntValue();
+        }
+
+        return stats;
+    }
+}
+
+// Cost of opening a session with many instances: constructing them, preparing them,
+// loading the same impulse response into each and restoring their saved state, plus the
+// memory and threads they add. The state is restored once as the XML the plugin saves and
+// once as a binary ValueTree, to show what a change of format would gain.
+// Memory and thread counts are only available on Linux.
+void Benchmarks::runStartup()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    auto irFile = writeTestImpulseResponse(1.0, sampleRate);
+
+    std::printf("%-10s %10s %11s %11s %11s %11s %11s %10s %8s\n", "instances", "create ms", "prepare ms",
+                "IR load ms", "XML rest ms", "bin rest ms", "MB total", "KB/inst", "threads");
+
+    for (int count : { 1, 10, 100, 200 })
+    {
+        auto before = readProcessStats();
+        std::vector<std::unique_ptr<RetroizerAudioProcessor>> instances;
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < count; ++i)
+            instances.push_back(std::make_unique<RetroizerAudioProcessor>());
+
+        double createSeconds = secondsSince(start);
+        start = juce::Time::getHighResolutionTicks();
+
+        for (auto& instance : instances)
+        {
+            instance->setRateAndBufferSizeDetails(sampleRate, blockSize);
+            instance->prepareToPlay(sampleRate, blockSize);
+        }
+
+        double prepareSeconds = secondsSince(start);
+        start = juce::Time::getHighResolutionTicks();
+
+        for (auto& instance : instances)
+        {
+            setParameter(*instance, Parameters::ID::radioMode, 1.0f);
+            setParameter(*instance, Parameters::ID::radioMix1, 1.0f);
+            instance->loadRadioImpulseResponse(irFile);
+        }
+
+        double irSeconds = secondsSince(start);
+
+        // The same state in both formats, as a host would hand it back when reopening
+        juce::MemoryBlock xmlState, binaryState;
+        instances.front()->getStateInformation(xmlState);
+
+        {
+            juce::MemoryOutputStream stream(binaryState, false);
+            instances.front()->apvts.copyState().writeToStream(stream);
+        }
+
+        auto restoreAll = [&instances](const juce::MemoryBlock& state)
+        {
+            auto restoreStart = juce::Time::getHighResolutionTicks();
+
+            for (auto& instance : instances)
+                instance->setStateInformation(state.getData(), (int)state.getSize());
+
+            return secondsSince(restoreStart);
+        };
+
+        double xmlRestoreSeconds = restoreAll(xmlState);
+        double binaryRestoreSeconds = restoreAll(binaryState);
+
+        // Give the background loader time to partition every IR, then let each instance
+        // swap its engine in, so the partitioned copies are part of the memory figure
+        juce::Thread::sleep(500 + 5 * count);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        for (auto& instance : instances)
+        {
+            buffer.clear();
+            instance->processBlock(buffer, midi);
+        }
+
+        auto after = readProcessStats();
+
+        std::printf("%-10d %10.1f %11.1f %11.1f %11.1f %11.1f %11.1f %10.1f %8d\n", count,
+                    createSeconds * 1000.0, prepareSeconds * 1000.0, irSeconds * 1000.0,
+                    xmlRestoreSeconds * 1000.0, binaryRestoreSeconds * 1000.0, after.residentMB, (after.residentMB - before.residentMB) * 1024.0 / count,
+                    after.threads - before.threads);
+    }
+}
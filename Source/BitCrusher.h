@@ -1,53 +1,74 @@
 #pragma once
 #include <JuceHeader.h>
+#include "DSPCore.h"
 
 class BitCrusher
 {
 public:
+    // Both channels of a stereo pair are processed together, one lane each
+    static constexpr int maxChannels = 2;
+
     BitCrusher() = default;
-    
+
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
         reset();
     }
-    
-    void process(float* buffer, int numSamples)
+
+    void process(float* const* channels, int numChannels, int numSamples)
     {
-        for (int i = 0; i < numSamples; ++i)
+        numChannels = juce::jmin(numChannels, maxChannels);
+
+        // Linked lanes sample and hold at the same instants
+        if (linked)
+            hold[1].phase = hold[0].phase;
+
+        // Without rate reduction every sample is kept, so quantize the whole pair in one
+        // branch-free loop; the quantizer's rounding lets the compiler vectorize it at -O3
+        if (numChannels == maxChannels && holdLength[0] == 1 && holdLength[1] == 1)
         {
-            // Apply bit reduction
-            float step = powf(0.5f, bitDepth);
-            buffer[i] = floor(buffer[i] / step + 0.5f) * step;
-            
-            // Apply sample rate reduction
-            if (sampleRateDivisor > 1)
+            float* left = channels[0];
+            float* right = channels[1];
+            const auto quantizeLeft = quantizer[0], quantizeRight = quantizer[1];
+
+            for (int i = 0; i < numSamples; ++i)
             {
-                if (sampleCount % sampleRateDivisor != 0)
-                {
-                    buffer[i] = holdSample;
-                }
-                else
-                {
-                    holdSample = buffer[i];
-                }
-                sampleCount++;
+                left[i] = quantizeLeft(left[i]);
+                right[i] = quantizeRight(right[i]);
             }
+
+            return;
         }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            DSPCore::crushLane(channels[channel], 1, numSamples, holdLength[channel], quantizer[channel], hold[channel]);
     }
-    
-    void setBitDepth(float depth) { bitDepth = juce::jmax(1.0f, depth * 15.0f + 1.0f); } // 1-16 bits
-    void setSampleRateReduction(float amount) { sampleRateDivisor = juce::jmax(1, (int)(amount * 32.0f)); }
+
+    void setBitDepth(int channel, float depth) // 1-16 bits
+    {
+        quantizer[channel].setBits(DSPCore::bitsFromParameter(depth));
+    }
+
+    void setSampleRateReduction(int channel, float amount)
+    {
+        holdLength[channel] = DSPCore::holdLengthFromParameter(amount);
+        hold[channel].phase %= holdLength[channel];
+    }
+
+    // When linked, both lanes share the hold clock of the first one
+    void setLinked(bool shouldBeLinked) { linked = shouldBeLinked; }
+
     void reset()
     {
-        holdSample = 0.0f;
-        sampleCount = 0;
+        for (auto& lane : hold)
+            lane = {};
     }
-    
+
 private:
-    float bitDepth = 16.0f;
-    int sampleRateDivisor = 1;
-    float holdSample = 0.0f;
-    int sampleCount = 0;
+    DSPCore::Quantizer quantizer[maxChannels];
+    int holdLength[maxChannels] = { 1, 1 };
+    DSPCore::HoldState hold[maxChannels];
+    bool linked = false;
     double sampleRate = 44100.0;
-};
\ No newline at end of file
+};
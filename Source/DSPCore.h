@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// The bit crusher and the radio band-pass design without any JUCE, shared by the plugin and
+// the embeddable DSP in Source/Embed so both produce the same sound from the same parameters.
+namespace DSPCore
+{
+    // Bit Depth parameter (0..1) to bits (1..16)
+    inline float bitsFromParameter(float depth)
+    {
+        return std::max(1.0f, depth * 15.0f + 1.0f);
+    }
+
+    // Sample Rate Reduction parameter (0..1) to the number of samples each held value lasts (1..32)
+    inline int holdLengthFromParameter(float amount)
+    {
+        return std::max(1, (int)(amount * 32.0f));
+    }
+
+    // Rounds samples to a grid of 2^-bits
+    struct Quantizer
+    {
+        // Only recomputes the step when the depth actually moves
+        void setBits(float newBits)
+        {
+            if (newBits != bits)
+            {
+                bits = newBits;
+                step = std::pow(0.5f, bits);
+                invStep = 1.0f / step;
+            }
+        }
+
+        // Rounds half up, i.e. floor(x + 0.5), with the floor done through an int conversion.
+        // std::floor only vectorizes with SSE4.1 and -fno-trapping-math; this vectorizes on
+        // baseline x86-64. Samples must stay within +-32768 (about +90 dBFS).
+        float operator()(float sample) const
+        {
+            float scaled = sample * invStep + 0.5f;
+            int rounded = (int)scaled;
+            rounded -= (float)rounded > scaled;
+            return (float)rounded * step;
+        }
+
+        float bits = 16.0f;
+        float step = 1.0f / 65536.0f;
+        float invStep = 65536.0f;
+    };
+
+    // Sample and hold position of one lane, carried across calls
+    struct HoldState
+    {
+        float sample = 0.0f;
+        int phase = 0;
+    };
+
+    // Crushes one lane in place; stride is the distance between its samples (1 for planar).
+    // Only the sample at the start of each hold run survives the rate reduction, so just that
+    // one is quantized and written over the run. A run cut off at the end of the call carries
+    // on into the next one.
+    inline void crushLane(float* data, std::ptrdiff_t stride, int numSamples, int holdLength,
+                          const Quantizer& quantize, HoldState& hold)
+    {
+        if (holdLength == 1)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i * stride] = quantize(data[i * stride]);
+
+            return;
+        }
+
+        for (int i = 0; i < numSamples;)
+        {
+            if (hold.phase == 0)
+                hold.sample = quantize(data[i * stride]);
+
+            int run = std::min(holdLength - hold.phase, numSamples - i);
+
+            for (int end = i + run; i < end; ++i)
+                data[i * stride] = hold.sample;
+
+            hold.phase = hold.phase + run == holdLength ? 0 : hold.phase + run;
+        }
+    }
+
+    // Bilinear band-pass, normalised so a0 == 1. A band-pass has b1 == 0, so it is left out.
+    struct BandPassCoefficients
+    {
+        float b0, b2, a1, a2;
+    };
+
+    inline BandPassCoefficients designBandPass(double sampleRate, double frequency, double q)
+    {
+        const double pi = 3.14159265358979323846;
+        double n = 1.0 / std::tan(pi * frequency / sampleRate);
+        double nSquared = n * n;
+        double c1 = 1.0 / (1.0 + n / q + nSquared);
+
+        return { (float)(c1 * n / q),
+                 (float)(-c1 * n / q),
+                 (float)(c1 * 2.0 * (1.0 - nSquared)),
+                 (float)(c1 * (1.0 - n / q + nSquared)) };
+    }
+}
@@ -0,0 +1,299 @@
+#include "RetroizerDSP.h"
+#include "../DSPCore.h"
+#include "../ProcessingGrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <new>
+
+namespace
+{
+    constexpr int maxChannels = 2;
+
+    // Same control grid and smoothing time as the plugin
+    constexpr int controlInterval = ProcessingGrid::controlInterval;
+    constexpr double smoothingSeconds = 0.02;
+
+    // Linear ramp towards a target, advanced once per control interval
+    struct Ramp
+    {
+        void setTarget(float newTarget, int steps)
+        {
+            if (newTarget != target)
+            {
+                target = newTarget;
+                remaining = steps;
+                increment = (target - current) / (float)steps;
+            }
+        }
+
+        void setCurrentAndTarget(float value)
+        {
+            current = target = value;
+            remaining = 0;
+        }
+
+        float next()
+        {
+            if (remaining > 0)
+                current = --remaining == 0 ? target : current + increment;
+
+            return current;
+        }
+
+        float current = 0.0f, target = 0.0f, increment = 0.0f;
+        int remaining = 0;
+    };
+
+    // Transposed direct form II band-pass with the plugin's filter design
+    struct BandPass
+    {
+        void design(double sampleRate, double frequency, double q)
+        {
+            coefficients = DSPCore::designBandPass(sampleRate, frequency, q);
+        }
+
+        void reset()
+        {
+            for (int channel = 0; channel < maxChannels; ++channel)
+                s1[channel] = s2[channel] = 0.0f;
+        }
+
+        // Mixes the filtered signal into one channel of a strided buffer
+        void process(int channel, float* data, std::ptrdiff_t stride, int numFrames, float mix)
+        {
+            const auto c = coefficients;
+            float state1 = s1[channel], state2 = s2[channel];
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                float dry = data[i * stride];
+                float wet = dry * c.b0 + state1;
+                state1 = state2 - wet * c.a1;
+                state2 = dry * c.b2 - wet * c.a2;
+                data[i * stride] = dry + (wet - dry) * mix;
+            }
+
+            s1[channel] = state1;
+            s2[channel] = state2;
+        }
+
+        DSPCore::BandPassCoefficients coefficients {};
+        float s1[maxChannels] = {}, s2[maxChannels] = {};
+    };
+
+    // Parameters published by one writer and read by the audio thread without locking.
+    // The writer makes the sequence odd while it stores; the reader throws away any copy
+    // taken while it was odd or that it changed under, and keeps its previous values.
+    class ParameterExchange
+    {
+    public:
+        void write(const RetroizerParams& params)
+        {
+            auto start = sequence.load(std::memory_order_relaxed);
+            sequence.store(start + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            values[0].store(params.bitDepth, std::memory_order_relaxed);
+            values[1].store(params.sampleRate, std::memory_order_relaxed);
+            values[2].store(params.radioMix1, std::memory_order_relaxed);
+            values[3].store(params.radioMix2, std::memory_order_relaxed);
+
+            sequence.store(start + 2, std::memory_order_release);
+        }
+
+        // Returns true and fills params when there is a complete update not read yet
+        bool read(RetroizerParams& params)
+        {
+            auto start = sequence.load(std::memory_order_acquire);
+
+            if (start == lastRead || (start & 1) != 0)
+                return false;
+
+            RetroizerParams copy;
+            copy.bitDepth = values[0].load(std::memory_order_relaxed);
+            copy.sampleRate = values[1].load(std::memory_order_relaxed);
+            copy.radioMix1 = values[2].load(std::memory_order_relaxed);
+            copy.radioMix2 = values[3].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) != start)
+                return false;
+
+            lastRead = start;
+            params = copy;
+            return true;
+        }
+
+        // Makes the current values count as unread again
+        void invalidate() { lastRead = ~std::uint32_t(0); }
+
+    private:
+        std::atomic<std::uint32_t> sequence { 0 };
+        std::atomic<float> values[4] = {};
+        std::uint32_t lastRead = 0;
+    };
+}
+
+struct RetroizerEffect
+{
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        rampSteps = std::max(1, (int)std::lround(smoothingSeconds * sampleRate / controlInterval));
+
+        radioFilter1.design(sampleRate, 800.0, 0.5);
+        radioFilter2.design(sampleRate, 1200.0, 0.7);
+
+        // The first parameters after preparing jump straight to their values. The read fails
+        // while a write is in progress, and then the last applied ones stand in until the
+        // next interval picks the new ones up.
+        parameters.invalidate();
+        RetroizerParams params = appliedParams;
+        parameters.read(params);
+        applyParams(params, true);
+
+        reset();
+    }
+
+    void reset()
+    {
+        radioFilter1.reset();
+        radioFilter2.reset();
+
+        for (auto& lane : hold)
+            lane = {};
+
+        intervalPosition = 0;
+    }
+
+    // Runs the chain over up to two strided channels, one control interval at a time,
+    // carrying the interval grid across calls like the plugin does across host blocks
+    void process(float* const* channels, int numChannels, std::ptrdiff_t stride, int numFrames)
+    {
+        numChannels = std::min(numChannels, maxChannels);
+
+        for (int start = 0; start < numFrames;)
+        {
+            if (intervalPosition == 0)
+                updateInterval();
+
+            int length = std::min(controlInterval - intervalPosition, numFrames - start);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                float* data = channels[channel] + start * stride;
+
+                DSPCore::crushLane(data, stride, length, holdLength, quantizer, hold[channel]);
+
+                if (mix1 != 0.0f)
+                    radioFilter1.process(channel, data, stride, length, mix1);
+
+                if (mix2 != 0.0f)
+                    radioFilter2.process(channel, data, stride, length, mix2);
+            }
+
+            start += length;
+            intervalPosition = (intervalPosition + length) % controlInterval;
+        }
+    }
+
+    ParameterExchange parameters;
+
+private:
+    void applyParams(const RetroizerParams& params, bool immediately)
+    {
+        appliedParams = params;
+
+        auto clamp = [](float value) { return std::min(1.0f, std::max(0.0f, value)); };
+        Ramp* ramps[] = { &bitDepth, &sampleRateReduction, &radioMix1, &radioMix2 };
+        float targets[] = { params.bitDepth, params.sampleRate, params.radioMix1, params.radioMix2 };
+
+        for (int i = 0; i < 4; ++i)
+        {
+            if (immediately)
+                ramps[i]->setCurrentAndTarget(clamp(targets[i]));
+            else
+                ramps[i]->setTarget(clamp(targets[i]), rampSteps);
+        }
+    }
+
+    void updateInterval()
+    {
+        RetroizerParams params;
+
+        if (parameters.read(params))
+            applyParams(params, false);
+
+        quantizer.setBits(DSPCore::bitsFromParameter(bitDepth.next()));
+        holdLength = DSPCore::holdLengthFromParameter(sampleRateReduction.next());
+
+        for (auto& lane : hold)
+            lane.phase %= holdLength;
+
+        mix1 = radioMix1.next();
+        mix2 = radioMix2.next();
+    }
+
+    double sampleRate = 44100.0;
+    int rampSteps = 1;
+    int intervalPosition = 0;
+
+    Ramp bitDepth, sampleRateReduction, radioMix1, radioMix2;
+    RetroizerParams appliedParams { 1.0f, 0.0f, 0.0f, 0.0f }; // The lightest settings
+
+    // One setting for both channels; each keeps its own hold position
+    DSPCore::Quantizer quantizer;
+    int holdLength = 1;
+    DSPCore::HoldState hold[maxChannels];
+
+    BandPass radioFilter1, radioFilter2;
+    float mix1 = 0.0f, mix2 = 0.0f;
+};
+
+//==============================================================================
+size_t retroizer_memory_size(void) { return sizeof(RetroizerEffect); }
+size_t retroizer_memory_alignment(void) { return alignof(RetroizerEffect); }
+
+RetroizerEffect* retroizer_create(void* memory, size_t size)
+{
+    if (memory == nullptr || size < sizeof(RetroizerEffect)
+        || reinterpret_cast<std::uintptr_t>(memory) % alignof(RetroizerEffect) != 0)
+        return nullptr;
+
+    // Starts at the lightest settings: 16 bits, no rate reduction, both radio mixes off
+    auto* effect = new (memory) RetroizerEffect();
+    RetroizerParams lightest { 1.0f, 0.0f, 0.0f, 0.0f };
+    effect->parameters.write(lightest);
+    effect->prepare(44100.0);
+    return effect;
+}
+
+void retroizer_destroy(RetroizerEffect* effect)
+{
+    if (effect != nullptr)
+        effect->~RetroizerEffect();
+}
+
+void retroizer_prepare(RetroizerEffect* effect, double sampleRate) { effect->prepare(sampleRate); }
+void retroizer_reset(RetroizerEffect* effect) { effect->reset(); }
+
+void retroizer_set_params(RetroizerEffect* effect, const RetroizerParams* params)
+{
+    effect->parameters.write(*params);
+}
+
+void retroizer_process_planar(RetroizerEffect* effect, float* const* channels, int numChannels, int numFrames)
+{
+    effect->process(channels, numChannels, 1, numFrames);
+}
+
+void retroizer_process_interleaved(RetroizerEffect* effect, float* samples, int numChannels, int numFrames)
+{
+    // Interleaved channels are just planar channels with a stride of one frame
+    float* channels[maxChannels] = { samples, samples + 1 };
+    effect->process(channels, numChannels, numChannels, numFrames);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Standalone Retroizer DSP for embedding in a host mixer, without JUCE, a plugin wrapper
+// or a message thread. It runs the bit crusher and the two radio band-passes on the same
+// 64-sample control grid as the plugin. The convolution and noise stages are plugin-only.
+//
+// No function allocates: each effect lives in memory the caller provides, which must be
+// at least retroizer_memory_size() bytes aligned to retroizer_memory_alignment(). Every
+// function except retroizer_set_params() must be called from one thread at a time (the
+// audio thread). retroizer_set_params() may be called from one other thread concurrently.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RetroizerEffect RetroizerEffect;
+
+// All values are 0..1, matching the plugin parameters of the same name. As in the plugin,
+// bitDepth 0 is the heaviest crush (1 bit) and 1 is 16 bits.
+typedef struct RetroizerParams
+{
+    float bitDepth;
+    float sampleRate;
+    float radioMix1;
+    float radioMix2;
+} RetroizerParams;
+
+size_t retroizer_memory_size(void);
+size_t retroizer_memory_alignment(void);
+
+// Constructs an effect in the given memory at its lightest settings: bitDepth 1 (16 bits)
+// and everything else 0. That only quantizes to 16 bits; it is not a bit-exact bypass.
+// Returns NULL if the memory is too small or misaligned. The memory stays owned by the
+// caller and may be released after retroizer_destroy().
+RetroizerEffect* retroizer_create(void* memory, size_t size);
+void retroizer_destroy(RetroizerEffect* effect);
+
+// Sets the sample rate and clears the effect state. Parameter changes are smoothed from
+// here on; the first parameters after prepare apply immediately.
+void retroizer_prepare(RetroizerEffect* effect, double sampleRate);
+void retroizer_reset(RetroizerEffect* effect);
+
+// Safe to call from one writer thread while another thread processes. A change is
+// picked up at the start of the next 64-sample interval and ramped in over 20 ms.
+void retroizer_set_params(RetroizerEffect* effect, const RetroizerParams* params);
+
+// Both process in place. Only the first two channels are processed; any further
+// channels of an interleaved buffer are skipped over and left untouched.
+void retroizer_process_planar(RetroizerEffect* effect, float* const* channels, int numChannels, int numFrames);
+void retroizer_process_interleaved(RetroizerEffect* effect, float* samples, int numChannels, int numFrames);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,139 @@
+#pragma once
+#include <JuceHeader.h>
+#include "ProcessingGrid.h"
+
+class EnvelopeFollower
+{
+public:
+    enum class Detector { peak, rms };
+
+    // The envelope is updated once per control interval of the processing grid rather than per sample
+    static constexpr int controlInterval = ProcessingGrid::controlInterval;
+
+    static constexpr int maxChannels = 2;
+
+    EnvelopeFollower() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        updateCoefficients();
+        reset();
+    }
+
+    void setAttack(float ms)
+    {
+        if (ms != attackMs)
+        {
+            attackMs = ms;
+            updateCoefficients();
+        }
+    }
+
+    void setRelease(float ms)
+    {
+        if (ms != releaseMs)
+        {
+            releaseMs = ms;
+            updateCoefficients();
+        }
+    }
+
+    void setDetector(Detector newDetector) { detector = newDetector; }
+
+    // Measures all or part of one control interval across up to two channels and returns
+    // the envelope, clamped to 0..1. The envelope only moves once a whole interval has been
+    // measured, so its timing doesn't depend on how the host splits its blocks.
+    float process(const float* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        numChannels = juce::jmin(numChannels, maxChannels);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + startSample;
+
+            if (detector == Detector::peak)
+            {
+                auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+                intervalLevel[channel] = juce::jmax(intervalLevel[channel], -range.getStart(), range.getEnd());
+            }
+            else
+                intervalLevel[channel] += sumOfSquares(data, numSamples);
+        }
+
+        samplesMeasured += numSamples;
+
+        if (samplesMeasured >= controlInterval)
+        {
+            float level = 0.0f;
+
+            for (int channel = 0; channel < maxChannels; ++channel)
+            {
+                level = juce::jmax(level, detector == Detector::rms ? intervalLevel[channel] / (float)samplesMeasured
+                                                                    : intervalLevel[channel]);
+                intervalLevel[channel] = 0.0f;
+            }
+
+            samplesMeasured = 0;
+
+            // The RMS detector smooths the mean square; the square root is taken once per interval
+            float coeff = level > state ? attackCoeff : releaseCoeff;
+            state = level + coeff * (state - level);
+            envelope = juce::jmin(1.0f, detector == Detector::rms ? std::sqrt(state) : state);
+        }
+
+        return envelope;
+    }
+
+    // Pass how far into the current control interval the caller is, so the envelope keeps
+    // moving on the interval boundaries when it is reset part way through one
+    void reset(int samplesIntoInterval = 0)
+    {
+        state = 0.0f;
+        envelope = 0.0f;
+        samplesMeasured = samplesIntoInterval;
+
+        for (auto& level : intervalLevel)
+            level = 0.0f;
+    }
+
+private:
+    static float sumOfSquares(const float* data, int numSamples)
+    {
+        // Four independent accumulators so the compiler can keep the sum in one vector register
+        float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            for (int lane = 0; lane < 4; ++lane)
+                acc[lane] += data[i + lane] * data[i + lane];
+
+        for (; i < numSamples; ++i)
+            acc[0] += data[i] * data[i];
+
+        return acc[0] + acc[1] + acc[2] + acc[3];
+    }
+
+    void updateCoefficients()
+    {
+        // One-pole coefficients for a whole control interval, so no exp() on the audio path
+        auto intervalCoeff = [this](float ms)
+        {
+            return (float)std::exp(-controlInterval / (juce::jmax(0.01, (double)ms) * 0.001 * sampleRate));
+        };
+
+        attackCoeff = intervalCoeff(attackMs);
+        releaseCoeff = intervalCoeff(releaseMs);
+    }
+
+    Detector detector = Detector::peak;
+    float attackMs = 5.0f;
+    float releaseMs = 150.0f;
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    float state = 0.0f;
+    float envelope = 0.0f;
+    float intervalLevel[maxChannels] = { 0.0f, 0.0f };
+    int samplesMeasured = 0;
+    double sampleRate = 44100.0;
+};
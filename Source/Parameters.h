@@ -0,0 +1,178 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Single table describing every plugin parameter. The APVTS layout, the editor
+// attachments and the per-block snapshot are all generated from it, so adding a
+// parameter means adding one ID and one descriptor.
+namespace Parameters
+{
+    // Order matches the table below and is the order hosts see the parameters in
+    enum class ID
+    {
+        bitDepth,
+        sampleRate,
+        radioMix1,
+        radioMix2,
+        radioMode,
+        stereoMode,
+        sideLink,
+        sideBitDepth,
+        sideSampleRate,
+        sideRadioMix1,
+        sideRadioMix2,
+        envAttack,
+        envRelease,
+        envDetector,
+        envSidechain,
+        envToBitDepth,
+        envToSampleRate,
+        envToRadioMix1,
+        envToRadioMix2,
+        noiseStatic,
+        noiseCrackle,
+        noiseHum,
+        humFrequency,
+        noiseFollow,
+        adaptiveQuality,
+        count
+    };
+
+    constexpr size_t numParameters = (size_t)ID::count;
+
+    enum class Type { floating, choice, toggle };
+
+    // Editor section a parameter's control is placed in, in display order. Hidden
+    // parameters stay automatable but get no control.
+    enum class Section { crusher, radio, stereo, envelope, noise, performance, hidden };
+    constexpr size_t numSections = (size_t)Section::hidden;
+
+    struct Descriptor
+    {
+        ID index;
+        const char* id;
+        const char* name;
+        Type type;
+        float minValue, maxValue, defaultValue, skew;
+        const char* choices; // '|' separated, choice parameters only
+        Section section;
+    };
+
+    constexpr std::array<Descriptor, numParameters> descriptors {{
+        // Bit Crusher parameters
+        { ID::bitDepth,        "bitDepth",        "Bit Depth",                  Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::crusher },
+        { ID::sampleRate,      "sampleRate",      "Sample Rate Reduction",      Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::crusher },
+
+        // Radio Effect parameters
+        { ID::radioMix1,       "radioMix1",       "Radio Mix 1",                Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::radio },
+        { ID::radioMix2,       "radioMix2",       "Radio Mix 2",                Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::radio },
+        { ID::radioMode,       "radioMode",       "Radio Mode",                 Type::choice,   0.0f,    1.0f, 0.0f,   1.0f, "Filters|Convolution",     Section::radio },
+
+        // Stereo processing parameters
+        { ID::stereoMode,      "stereoMode",      "Stereo Mode",                Type::choice,   0.0f,    2.0f, 0.0f,   1.0f, "Stereo|Linked|Mid/Side",  Section::stereo },
+        { ID::sideLink,        "sideLink",        "Side Link",                  Type::toggle,   0.0f,    1.0f, 1.0f,   1.0f, nullptr,                   Section::stereo },
+        { ID::sideBitDepth,    "sideBitDepth",    "Side Bit Depth",             Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::stereo },
+        { ID::sideSampleRate,  "sideSampleRate",  "Side Sample Rate Reduction", Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::stereo },
+        { ID::sideRadioMix1,   "sideRadioMix1",   "Side Radio Mix 1",           Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::stereo },
+        { ID::sideRadioMix2,   "sideRadioMix2",   "Side Radio Mix 2",           Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::stereo },
+
+        // Envelope follower parameters
+        { ID::envAttack,       "envAttack",       "Envelope Attack",            Type::floating, 0.1f,  100.0f, 5.0f,   0.4f, nullptr,                   Section::envelope },
+        { ID::envRelease,      "envRelease",      "Envelope Release",           Type::floating, 5.0f, 1000.0f, 150.0f, 0.4f, nullptr,                   Section::envelope },
+        { ID::envDetector,     "envDetector",     "Envelope Detector",          Type::choice,   0.0f,    1.0f, 0.0f,   1.0f, "Peak|RMS",                Section::envelope },
+        { ID::envSidechain,    "envSidechain",    "Envelope Sidechain",         Type::toggle,   0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::envelope },
+
+        // Envelope modulation depths, bipolar so a loud input can push a parameter either way
+        { ID::envToBitDepth,   "envToBitDepth",   "Envelope to Bit Depth",      Type::floating, -1.0f,   1.0f, 0.0f,   1.0f, nullptr,                   Section::envelope },
+        { ID::envToSampleRate, "envToSampleRate", "Envelope to Sample Rate",    Type::floating, -1.0f,   1.0f, 0.0f,   1.0f, nullptr,                   Section::envelope },
+        { ID::envToRadioMix1,  "envToRadioMix1",  "Envelope to Radio Mix 1",    Type::floating, -1.0f,   1.0f, 0.0f,   1.0f, nullptr,                   Section::envelope },
+        { ID::envToRadioMix2,  "envToRadioMix2",  "Envelope to Radio Mix 2",    Type::floating, -1.0f,   1.0f, 0.0f,   1.0f, nullptr,                   Section::envelope },
+
+        // Radio noise parameters
+        { ID::noiseStatic,     "noiseStatic",     "Static",                     Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::noise },
+        { ID::noiseCrackle,    "noiseCrackle",    "Crackle",                    Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::noise },
+        { ID::noiseHum,        "noiseHum",        "Hum",                        Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::noise },
+        { ID::humFrequency,    "humFrequency",    "Hum Frequency",              Type::choice,   0.0f,    1.0f, 0.0f,   1.0f, "50 Hz|60 Hz",             Section::noise },
+        { ID::noiseFollow,     "noiseFollow",     "Noise Follow",               Type::floating, 0.0f,    1.0f, 0.0f,   1.0f, nullptr,                   Section::noise },
+
+        // Performance parameters
+        { ID::adaptiveQuality, "adaptiveQuality", "Adaptive Quality",           Type::toggle,   0.0f,    1.0f, 1.0f,   1.0f, nullptr,                   Section::performance },
+    }};
+
+    constexpr bool isTableInOrder()
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            if ((size_t)descriptors[i].index != i)
+                return false;
+
+        return true;
+    }
+
+    static_assert(isTableInOrder(), "Parameter descriptors must be listed in ID order");
+    static_assert(numParameters <= 64, "Snapshot change flags are a 64-bit mask");
+
+    constexpr const Descriptor& get(ID id) { return descriptors[(size_t)id]; }
+    constexpr const char* idOf(ID id) { return get(id).id; }
+
+    inline std::unique_ptr<juce::RangedAudioParameter> createParameter(const Descriptor& d)
+    {
+        switch (d.type)
+        {
+            case Type::choice:
+                return std::make_unique<juce::AudioParameterChoice>(
+                    d.id, d.name, juce::StringArray::fromTokens(d.choices, "|", ""), (int)d.defaultValue);
+
+            case Type::toggle:
+                return std::make_unique<juce::AudioParameterBool>(d.id, d.name, d.defaultValue >= 0.5f);
+
+            case Type::floating:
+            default:
+                return std::make_unique<juce::AudioParameterFloat>(
+                    d.id, d.name, juce::NormalisableRange<float>(d.minValue, d.maxValue, 0.0f, d.skew), d.defaultValue);
+        }
+    }
+
+    // Plain copy of every parameter value for one block, with a flag for each value that
+    // moved since the previous block so the DSP only recomputes the affected stages
+    struct Snapshot
+    {
+        float values[numParameters];
+        std::uint64_t changed;
+
+        float operator[](ID id) const { return values[(size_t)id]; }
+        bool hasChanged(ID id) const { return ((changed >> (size_t)id) & 1) != 0; }
+    };
+
+    // Raw parameter atomics, resolved once by ID so blocks never look parameters up by string
+    class Sources
+    {
+    public:
+        void resolve(juce::AudioProcessorValueTreeState& apvts)
+        {
+            for (const auto& d : descriptors)
+                sources[(size_t)d.index] = apvts.getRawParameterValue(d.id);
+        }
+
+        float load(ID id) const { return sources[(size_t)id]->load(); }
+
+        // Pass forceAllChanged after a (re)preparation so every stage picks up its settings
+        void update(Snapshot& snapshot, bool forceAllChanged = false) const
+        {
+            std::uint64_t changed = 0;
+
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                float value = sources[i]->load(std::memory_order_relaxed);
+
+                if (value != snapshot.values[i])
+                    changed |= std::uint64_t(1) << i;
+
+                snapshot.values[i] = value;
+            }
+
+            snapshot.changed = forceAllChanged ? ~std::uint64_t(0) : changed;
+        }
+
+    private:
+        std::array<std::atomic<float>*, numParameters> sources {};
+    };
+}
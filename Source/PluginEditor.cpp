@@ -10,70 +10,142 @@
 #include "PluginEditor.h"
 
 //==============================================================================
+namespace
+{
+    struct SectionStyle
+    {
+        const char* title;
+        juce::Colour colour;
+    };
+
+    // Titles and accent colours, in Parameters::Section order
+    const SectionStyle sectionStyles[Parameters::numSections] = {
+        { "BIT CRUSHER",  juce::Colours::orangered },
+        { "RADIO EFFECT", juce::Colours::skyblue },
+        { "STEREO",       juce::Colours::mediumseagreen },
+        { "ENVELOPE",     juce::Colours::gold },
+        { "NOISE",        juce::Colours::orchid },
+        { "PERFORMANCE",  juce::Colours::grey },
+    };
+
+    constexpr int titleHeight = 40;
+    constexpr int statusHeight = 20;
+    constexpr int sectionTitleWidth = 110;
+    constexpr int controlWidth = 90;
+    constexpr int rowHeight = 110;
+
+    // Number of controls in the fullest section, which sets the editor width
+    constexpr int countLargestSection()
+    {
+        int counts[Parameters::numSections] = {};
+        int largest = 0;
+
+        for (const auto& descriptor : Parameters::descriptors)
+            if (descriptor.section != Parameters::Section::hidden)
+                largest = std::max(largest, ++counts[(size_t)descriptor.section]);
+
+        return largest;
+    }
+}
+
 RetroizerAudioProcessorEditor::RetroizerAudioProcessorEditor(RetroizerAudioProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p)
 {
-    // Set up the bit depth slider
-    bitDepthSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
-    bitDepthSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 90, 20);
-    bitDepthSlider.setColour(juce::Slider::thumbColourId, juce::Colours::orangered);
-    addAndMakeVisible(bitDepthSlider);
-
-    bitDepthLabel.setText("Bit Depth", juce::dontSendNotification);
-    bitDepthLabel.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(bitDepthLabel);
-
-    // Set up the sample rate slider
-    sampleRateSlider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
-    sampleRateSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 90, 20);
-    sampleRateSlider.setColour(juce::Slider::thumbColourId, juce::Colours::orangered);
-    addAndMakeVisible(sampleRateSlider);
-
-    sampleRateLabel.setText("Sample Rate", juce::dontSendNotification);
-    sampleRateLabel.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(sampleRateLabel);
-
-    // Set up the radio mix 1 slider
-    radioMix1Slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
-    radioMix1Slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 90, 20);
-    radioMix1Slider.setColour(juce::Slider::thumbColourId, juce::Colours::skyblue);
-    addAndMakeVisible(radioMix1Slider);
-
-    radioMix1Label.setText("Radio Mix 1", juce::dontSendNotification);
-    radioMix1Label.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(radioMix1Label);
-
-    // Set up the radio mix 2 slider
-    radioMix2Slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
-    radioMix2Slider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 90, 20);
-    radioMix2Slider.setColour(juce::Slider::thumbColourId, juce::Colours::skyblue);
-    addAndMakeVisible(radioMix2Slider);
-
-    radioMix2Label.setText("Radio Mix 2", juce::dontSendNotification);
-    radioMix2Label.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(radioMix2Label);
-
-    // Create parameter attachments
-    bitDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        audioProcessor.apvts, "bitDepth", bitDepthSlider);
-
-    sampleRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        audioProcessor.apvts, "sampleRate", sampleRateSlider);
-
-    radioMix1Attachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        audioProcessor.apvts, "radioMix1", radioMix1Slider);
-
-    radioMix2Attachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-        audioProcessor.apvts, "radioMix2", radioMix2Slider);
-
-    // Set the plugin window size
-    setSize(400, 300);
+    using Parameters::Type;
+    using APVTS = juce::AudioProcessorValueTreeState;
+
+    // One control per parameter, in table order: rotary sliders for continuous values,
+    // combo boxes for choices and toggle buttons for switches
+    for (const auto& descriptor : Parameters::descriptors)
+    {
+        if (descriptor.section == Parameters::Section::hidden)
+            continue;
+
+        auto control = std::make_unique<ParameterControl>(descriptor);
+        auto colour = sectionStyles[(size_t)descriptor.section].colour;
+
+        if (descriptor.type == Type::choice)
+        {
+            auto box = std::make_unique<juce::ComboBox>();
+            box->addItemList(juce::StringArray::fromTokens(descriptor.choices, "|", ""), 1);
+            control->comboBoxAttachment = std::make_unique<APVTS::ComboBoxAttachment>(audioProcessor.apvts, descriptor.id, *box);
+            control->component = std::move(box);
+        }
+        else if (descriptor.type == Type::toggle)
+        {
+            auto button = std::make_unique<juce::ToggleButton>();
+            button->setColour(juce::ToggleButton::tickColourId, colour);
+            control->buttonAttachment = std::make_unique<APVTS::ButtonAttachment>(audioProcessor.apvts, descriptor.id, *button);
+            control->component = std::move(button);
+        }
+        else
+        {
+            auto slider = std::make_unique<juce::Slider>(juce::Slider::RotaryVerticalDrag, juce::Slider::TextBoxBelow);
+            slider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 18);
+            slider->setColour(juce::Slider::thumbColourId, colour);
+            control->sliderAttachment = std::make_unique<APVTS::SliderAttachment>(audioProcessor.apvts, descriptor.id, *slider);
+            control->component = std::move(slider);
+        }
+
+        control->label.setText(descriptor.name, juce::dontSendNotification);
+        control->label.setJustificationType(juce::Justification::centred);
+        control->label.setFont(juce::FontOptions(12.0f));
+        control->label.setMinimumHorizontalScale(0.6f);
+
+        addAndMakeVisible(*control->component);
+        addAndMakeVisible(control->label);
+        controls.push_back(std::move(control));
+    }
+
+    loadIRButton.setTooltip(audioProcessor.getRadioImpulseResponseFile().getFileName());
+    loadIRButton.onClick = [this]
+    {
+        irChooser = std::make_unique<juce::FileChooser>(
+            "Select an impulse response", audioProcessor.getRadioImpulseResponseFile(), "*.wav;*.aif;*.aiff;*.flac");
+
+        irChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+            [this](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+
+                if (file.existsAsFile())
+                {
+                    audioProcessor.loadRadioImpulseResponse(file);
+                    loadIRButton.setTooltip(file.getFileName());
+                }
+            });
+    };
+    addAndMakeVisible(loadIRButton);
+
+    // Set up the quality status line
+    qualityLabel.setJustificationType(juce::Justification::centredRight);
+    qualityLabel.setFont(juce::FontOptions(12.0f));
+    addAndMakeVisible(qualityLabel);
+
+    // One row per section, wide enough for the fullest one
+    setSize(sectionTitleWidth + countLargestSection() * controlWidth + 10,
+            titleHeight + (int)Parameters::numSections * rowHeight + statusHeight);
+
+    timerCallback();
+    startTimerHz(4);
 }
 
 RetroizerAudioProcessorEditor::~RetroizerAudioProcessorEditor()
 {
 }
 
+void RetroizerAudioProcessorEditor::timerCallback()
+{
+    static const char* const qualityNames[] = { "Full", "Reduced" };
+
+    auto quality = audioProcessor.getQuality();
+    qualityLabel.setText(juce::String("Quality: ") + qualityNames[(int)quality]
+                             + "  CPU " + juce::String(juce::roundToInt(audioProcessor.getProcessingLoad() * 100.0f)) + "%",
+                         juce::dontSendNotification);
+    qualityLabel.setColour(juce::Label::textColourId, quality == RadioEffect::Quality::full ? juce::Colours::grey
+                                                                                           : juce::Colours::orange);
+}
+
 //==============================================================================
 void RetroizerAudioProcessorEditor::paint(juce::Graphics& g)
 {
@@ -83,57 +155,65 @@ void RetroizerAudioProcessorEditor::paint(juce::Graphics& g)
     // Draw a gradient title bar
     juce::ColourGradient gradient(
         juce::Colour(60, 60, 65), 0, 0,
-        juce::Colour(30, 30, 35), 0, 40,
+        juce::Colour(30, 30, 35), 0, titleHeight,
         false);
     g.setGradientFill(gradient);
-    g.fillRect(0, 0, getWidth(), 40);
+    g.fillRect(0, 0, getWidth(), titleHeight);
 
     // Draw plugin title
     g.setColour(juce::Colours::white);
     g.setFont(24.0f);
-    g.drawText("RETROIZER", getLocalBounds().removeFromTop(40), juce::Justification::centred);
-
-    // Draw section lines
-    g.setColour(juce::Colours::grey);
-    g.drawLine(getWidth() / 2, 50, getWidth() / 2, getHeight() - 10, 1.0f);
-    g.drawLine(10, 140, getWidth() - 10, 140, 1.0f);
+    g.drawText("RETROIZER", getLocalBounds().removeFromTop(titleHeight), juce::Justification::centred);
 
-    // Draw section titles
+    // Draw section titles with a line between sections
     g.setFont(16.0f);
-    g.setColour(juce::Colours::orangered);
-    g.drawText("BIT CRUSHER", 10, 45, getWidth() / 2 - 20, 20, juce::Justification::centred);
-    g.setColour(juce::Colours::skyblue);
-    g.drawText("RADIO EFFECT", getWidth() / 2 + 10, 45, getWidth() / 2 - 20, 20, juce::Justification::centred);
+
+    for (size_t section = 0; section < Parameters::numSections; ++section)
+    {
+        auto row = sectionBounds[section];
+
+        if (section > 0)
+        {
+            g.setColour(juce::Colours::grey);
+            g.drawHorizontalLine(row.getY(), 10.0f, (float)getWidth() - 10.0f);
+        }
+
+        g.setColour(sectionStyles[section].colour);
+        g.drawText(sectionStyles[section].title, row.removeFromLeft(sectionTitleWidth).reduced(10, 0),
+                   juce::Justification::centredLeft);
+    }
 }
 
 void RetroizerAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
-    bounds.removeFromTop(70); // Space for title
-
-    // Calculate areas for each control
-    int halfWidth = getWidth() / 2;
-    int controlHeight = (getHeight() - 70) / 2;
-
-    // Top row
-    auto topRow = bounds.removeFromTop(controlHeight);
-
-    // Bit depth (top left)
-    auto bitDepthArea = topRow.removeFromLeft(halfWidth);
-    bitDepthSlider.setBounds(bitDepthArea.reduced(10).removeFromTop(80));
-    bitDepthLabel.setBounds(bitDepthArea.reduced(10).removeFromTop(20));
-
-    // Radio mix 1 (top right)
-    radioMix1Slider.setBounds(topRow.reduced(10).removeFromTop(80));
-    radioMix1Label.setBounds(topRow.reduced(10).removeFromTop(20));
-
-    // Bottom row
-    // Sample rate (bottom left)
-    auto sampleRateArea = bounds.removeFromLeft(halfWidth);
-    sampleRateSlider.setBounds(sampleRateArea.reduced(10).removeFromTop(80));
-    sampleRateLabel.setBounds(sampleRateArea.reduced(10).removeFromTop(20));
-
-    // Radio mix 2 (bottom right)
-    radioMix2Slider.setBounds(bounds.reduced(10).removeFromTop(80));
-    radioMix2Label.setBounds(bounds.reduced(10).removeFromTop(20));
-}
\ No newline at end of file
+
+    // The IR loader sits at the right of the title
+    auto titleBar = bounds.removeFromTop(titleHeight).reduced(8);
+    loadIRButton.setBounds(titleBar.removeFromRight(80));
+
+    // Quality status along the bottom
+    qualityLabel.setBounds(bounds.removeFromBottom(statusHeight).reduced(10, 0));
+
+    for (auto& row : sectionBounds)
+        row = bounds.removeFromTop(rowHeight);
+
+    // Controls fill their section's row from the left, in table order
+    std::array<juce::Rectangle<int>, Parameters::numSections> remaining;
+
+    for (size_t section = 0; section < Parameters::numSections; ++section)
+        remaining[section] = sectionBounds[section].withTrimmedLeft(sectionTitleWidth);
+
+    for (auto& control : controls)
+    {
+        auto cell = remaining[(size_t)control->descriptor.section].removeFromLeft(controlWidth).reduced(4);
+        control->label.setBounds(cell.removeFromTop(18));
+
+        if (control->descriptor.type == Parameters::Type::floating)
+            control->component->setBounds(cell);
+        else if (control->descriptor.type == Parameters::Type::choice)
+            control->component->setBounds(cell.withSizeKeepingCentre(cell.getWidth(), 24));
+        else
+            control->component->setBounds(cell.withSizeKeepingCentre(24, 24));
+    }
+}
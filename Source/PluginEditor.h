@@ -3,7 +3,8 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-class RetroizerAudioProcessorEditor : public juce::AudioProcessorEditor
+class RetroizerAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                      private juce::Timer
 {
 public:
     explicit RetroizerAudioProcessorEditor(RetroizerAudioProcessor&);
@@ -13,25 +14,36 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
     RetroizerAudioProcessor& audioProcessor;
 
-    // Parameter sliders
-    juce::Slider bitDepthSlider;
-    juce::Slider sampleRateSlider;
-    juce::Slider radioMix1Slider;
-    juce::Slider radioMix2Slider;
-
-    // Labels for sliders
-    juce::Label bitDepthLabel;
-    juce::Label sampleRateLabel;
-    juce::Label radioMix1Label;
-    juce::Label radioMix2Label;
-
-    // Attachments for parameters
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> bitDepthAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sampleRateAttachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> radioMix1Attachment;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> radioMix2Attachment;
+    // One control per visible parameter, built from the descriptor table. Only the
+    // attachment matching the control type is set; it is declared after the control so
+    // it is destroyed first.
+    struct ParameterControl
+    {
+        explicit ParameterControl(const Parameters::Descriptor& d) : descriptor(d) {}
+
+        const Parameters::Descriptor& descriptor;
+        std::unique_ptr<juce::Component> component;
+        juce::Label label;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachment;
+    };
+
+    std::vector<std::unique_ptr<ParameterControl>> controls;
+
+    // Row each section occupies, kept for painting its title
+    std::array<juce::Rectangle<int>, Parameters::numSections> sectionBounds;
+
+    // Impulse response loading for the convolution mode of the radio stage
+    juce::TextButton loadIRButton { "Load IR..." };
+    std::unique_ptr<juce::FileChooser> irChooser;
+
+    // Current quality level and processing load
+    juce::Label qualityLabel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RetroizerAudioProcessorEditor)
 };
\ No newline at end of file
@@ -8,6 +8,7 @@ RetroizerAudioProcessor::RetroizerAudioProcessor()
 #if ! JucePlugin_IsMidiEffect
 #if ! JucePlugin_IsSynth
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
 #endif
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
@@ -15,6 +16,18 @@ RetroizerAudioProcessor::RetroizerAudioProcessor()
 #endif
     apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
+    parameters.resolve(apvts);
+
+#if RETROIZER_CLAP
+    // clap-juce-extensions derives each parameter's CLAP id from the hash of its JUCE id
+    for (const auto& d : Parameters::descriptors)
+        clapParameterIds[(size_t)d.index] = (juce::uint32)juce::String(d.id).hashCode();
+#endif
+
+    // Each instance gets its own noise so several of them don't add up coherently. The
+    // seed is kept in the state so a reloaded session renders the same noise again.
+    noiseSeed = (juce::uint32)juce::Random::getSystemRandom().nextInt();
+    apvts.state.setProperty("noiseSeed", (int)noiseSeed.load(), nullptr);
 }
 
 RetroizerAudioProcessor::~RetroizerAudioProcessor()
@@ -88,18 +101,66 @@ void RetroizerAudioProcessor::changeProgramName(int index, const juce::String& n
 //==============================================================================
 void RetroizerAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    // The DSP only ever sees one control interval at a time, whatever the host block size,
+    // so its scratch space is sized for that and nothing grows on the audio thread
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = ProcessingGrid::controlInterval;
     spec.numChannels = getTotalNumOutputChannels();
+    juce::ignoreUnused(samplesPerBlock);
+
+    // Hosts call prepareToPlay() again on every transport restart or bypass toggle; when
+    // nothing has changed only the DSP state needs clearing, not the filter design
+    bool specUnchanged = spec.sampleRate == preparedSpec.sampleRate
+                      && spec.maximumBlockSize == preparedSpec.maximumBlockSize
+                      && spec.numChannels == preparedSpec.numChannels;
 
-    bitCrusher.prepare(spec);
-    radioEffect.prepare(spec);
+    if (specUnchanged)
+    {
+        bitCrusher.reset();
+        radioEffect.reset();
+
+        for (auto& follower : envelopeFollowers)
+            follower.reset();
+    }
+    else
+    {
+        bitCrusher.prepare(spec);
+        radioEffect.prepare(spec);
+
+        for (auto& follower : envelopeFollowers)
+            follower.prepare(spec);
+
+        preparedSpec = spec;
+    }
+
+    auto resetSmoothed = [this, sampleRate](juce::SmoothedValue<float>& smoothed, Parameters::ID id)
+    {
+        smoothed.reset(sampleRate, 0.02);
+        smoothed.setCurrentAndTargetValue(parameters.load(id));
+    };
+
+    for (auto& lane : smoothers)
+    {
+        resetSmoothed(lane.bitDepth, Parameters::ID::bitDepth);
+        resetSmoothed(lane.sampleRate, Parameters::ID::sampleRate);
+        resetSmoothed(lane.radioMix1, Parameters::ID::radioMix1);
+        resetSmoothed(lane.radioMix2, Parameters::ID::radioMix2);
+    }
+
+    governor.prepare(sampleRate);
+
+    snapshotNeedsRefresh = true;
+    intervalPosition = 0;
+    envelopeWasActive = envelopeWasPerChannel = false;
 }
 
 void RetroizerAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this to free up any spare memory, etc.
+
+    // A stopped instance no longer adds to the process-wide load the other instances react to
+    governor.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -109,39 +170,295 @@ bool RetroizerAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
 
+    // The sidechain is optional and may be mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechain = layouts.getChannelSet(true, 1);
+
+        if (! sidechain.isDisabled()
+            && sidechain != juce::AudioChannelSet::mono()
+            && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
+
     return true;
 }
 #endif
 
 void RetroizerAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    auto blockStartTicks = juce::Time::getHighResolutionTicks();
     juce::ScopedNoDenormals noDenormals;
     // Avoid unused parameter warning
     juce::ignoreUnused(midiMessages);
 
-    // Get parameter values
-    auto bitDepthParam = apvts.getRawParameterValue("bitDepth");
-    auto sampleRateParam = apvts.getRawParameterValue("sampleRate");
-    auto radioMix1Param = apvts.getRawParameterValue("radioMix1");
-    auto radioMix2Param = apvts.getRawParameterValue("radioMix2");
+    const int numSamples = buffer.getNumSamples();
+
+#if RETROIZER_CLAP
+    // Each event splits the block where the host placed it, so its smoothing ramp starts
+    // on that sample. The segments refer to the host buffer and don't copy or allocate.
+    int nextEvent = 0;
+
+    for (int start = 0; start < numSamples;)
+    {
+        while (nextEvent < numParameterEvents && parameterEvents[(size_t)nextEvent].sample <= start)
+            applyParameterEvent(parameterEvents[(size_t)nextEvent++]);
+
+        int end = nextEvent < numParameterEvents ? juce::jmin(numSamples, parameterEvents[(size_t)nextEvent].sample)
+                                                 : numSamples;
+
+        juce::AudioBuffer<float> segment(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, end - start);
+        processSegment(segment);
+        start = end;
+    }
+
+    while (nextEvent < numParameterEvents)
+        applyParameterEvent(parameterEvents[(size_t)nextEvent++]);
+
+    numParameterEvents = 0;
+#else
+    processSegment(buffer);
+#endif
+
+    // Offline renders have no deadline, see processSegment()
+    if (snapshot[Parameters::ID::adaptiveQuality] >= 0.5f && ! isNonRealtime())
+        governor.update(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - blockStartTicks),
+                        numSamples);
+}
+
+void RetroizerAudioProcessor::processSegment(juce::AudioBuffer<float>& buffer)
+{
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    auto sidechainBuffer = getBusBuffer(buffer, true, 1);
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(mainBuffer.getNumChannels(), BitCrusher::maxChannels);
+
+    using Parameters::ID;
+    const int interval = ProcessingGrid::controlInterval;
 
-    // Update DSP parameters
-    bitCrusher.setBitDepth(bitDepthParam->load());
-    bitCrusher.setSampleRateReduction(sampleRateParam->load());
-    radioEffect.setMix1(radioMix1Param->load());
-    radioEffect.setMix2(radioMix2Param->load());
+    // Take one snapshot of every parameter for this block. Tiny host blocks that fall
+    // entirely inside the current control interval keep using the previous snapshot,
+    // since nothing downstream can react before the next interval starts anyway.
+    if (snapshotNeedsRefresh || parameterEventsApplied || intervalPosition == 0 || intervalPosition + numSamples > interval)
+        parameters.update(snapshot, snapshotNeedsRefresh);
+    else
+        snapshot.changed = 0;
 
-    // Process each channel
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    snapshotNeedsRefresh = false;
+    parameterEventsApplied = false;
+
+    radioEffect.getNoise().setSeed(noiseSeed.load(std::memory_order_relaxed));
+
+    if (snapshot.hasChanged(ID::radioMode))
+        radioEffect.setMode(snapshot[ID::radioMode] >= 0.5f ? RadioEffect::Mode::convolution
+                                                            : RadioEffect::Mode::filters);
+
+    if (snapshot.hasChanged(ID::noiseStatic) || snapshot.hasChanged(ID::noiseCrackle) || snapshot.hasChanged(ID::noiseHum)
+        || snapshot.hasChanged(ID::humFrequency) || snapshot.hasChanged(ID::noiseFollow))
+    {
+        auto& noise = radioEffect.getNoise();
+        noise.setStatic(snapshot[ID::noiseStatic]);
+        noise.setCrackle(snapshot[ID::noiseCrackle]);
+        noise.setHum(snapshot[ID::noiseHum]);
+        noise.setHumFrequency(snapshot[ID::humFrequency] >= 0.5f ? 60.0f : 50.0f);
+        noise.setFollow(snapshot[ID::noiseFollow]);
+    }
+
+    // Offline renders have no deadline and always run at full quality
+    bool adaptiveQuality = snapshot[ID::adaptiveQuality] >= 0.5f && ! isNonRealtime();
+
+    if (! adaptiveQuality)
+        governor.reset();
+
+    radioEffect.setQuality((RadioEffect::Quality)governor.getLevel());
+
+    auto stereoMode = (StereoMode)juce::roundToInt(snapshot[ID::stereoMode]);
+    bool midSide = stereoMode == StereoMode::midSide && numChannels == BitCrusher::maxChannels;
+    bool useSideSettings = midSide && snapshot[ID::sideLink] < 0.5f;
+
+    if (snapshot.hasChanged(ID::stereoMode))
+        bitCrusher.setLinked(stereoMode == StereoMode::linked);
+
+    // Update envelope followers
+    if (snapshot.hasChanged(ID::envAttack) || snapshot.hasChanged(ID::envRelease) || snapshot.hasChanged(ID::envDetector))
     {
-        auto* channelData = buffer.getWritePointer(channel);
+        for (auto& follower : envelopeFollowers)
+        {
+            follower.setAttack(snapshot[ID::envAttack]);
+            follower.setRelease(snapshot[ID::envRelease]);
+            follower.setDetector(snapshot[ID::envDetector] >= 0.5f ? EnvelopeFollower::Detector::rms
+                                                                   : EnvelopeFollower::Detector::peak);
+        }
+    }
+
+    // The detector stage is skipped entirely while nothing is modulated
+    bool envelopeActive = snapshot[ID::envToBitDepth] != 0.0f || snapshot[ID::envToSampleRate] != 0.0f
+                       || snapshot[ID::envToRadioMix1] != 0.0f || snapshot[ID::envToRadioMix2] != 0.0f;
+
+    // The follower listens to the sidechain when it is enabled and connected, otherwise to the input
+    bool useSidechain = snapshot[ID::envSidechain] >= 0.5f && sidechainBuffer.getNumChannels() > 0;
+    const auto& detectorBuffer = useSidechain ? sidechainBuffer : mainBuffer;
+
+    // In Stereo mode each lane follows its own channel; otherwise one envelope drives both
+    bool perChannelEnvelope = stereoMode == StereoMode::stereo && numChannels > 1;
+
+    // Followers that sat idle hold an old envelope and have lost the interval grid, so
+    // restart them in step with it whenever modulation starts or the routing changes
+    if (envelopeActive != envelopeWasActive || perChannelEnvelope != envelopeWasPerChannel)
+    {
+        for (auto& follower : envelopeFollowers)
+            follower.reset(intervalPosition);
+
+        envelopeWasActive = envelopeActive;
+        envelopeWasPerChannel = perChannelEnvelope;
+    }
+
+    auto* const* channels = mainBuffer.getArrayOfWritePointers();
+
+    // One pass over the block, one control interval at a time: the followers measure the
+    // interval before it is processed in place, the modulated targets go through their
+    // smoothers, then both channels of the pair run through the effects together.
+    // Nothing in here allocates or locks, whatever block size the host passes in.
+    // The interval grid runs continuously across host blocks, so an interval cut off at
+    // the end of one block is finished at the start of the next, in place and without copies.
+    for (int start = 0; start < numSamples;)
+    {
+        int length = juce::jmin(interval - intervalPosition, numSamples - start);
+        float envelope[BitCrusher::maxChannels] = { 0.0f, 0.0f };
+
+        if (envelopeActive && perChannelEnvelope)
+        {
+            for (int lane = 0; lane < numChannels; ++lane)
+            {
+                int detectorChannel = juce::jmin(lane, detectorBuffer.getNumChannels() - 1);
+                envelope[lane] = envelopeFollowers[(size_t)lane].process(
+                    detectorBuffer.getArrayOfReadPointers() + detectorChannel, 1, start, length);
+            }
+        }
+        else if (envelopeActive)
+        {
+            envelope[0] = envelope[1] = envelopeFollowers[0].process(
+                detectorBuffer.getArrayOfReadPointers(), detectorBuffer.getNumChannels(), start, length);
+        }
+
+        float* intervalChannels[BitCrusher::maxChannels] = {};
+
+        for (int lane = 0; lane < numChannels; ++lane)
+        {
+            auto modulate = [&envelope, lane, length](juce::SmoothedValue<float>& smoothed, float base, float amount)
+            {
+                smoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, base + envelope[lane] * amount));
+                return smoothed.skip(length);
+            };
+
+            // The side lane uses its own settings in Mid/Side mode unless it is linked to the mid
+            bool side = lane == 1 && useSideSettings;
+            auto& laneSmoothers = smoothers[(size_t)lane];
+
+            // Update DSP parameters
+            bitCrusher.setBitDepth(lane, modulate(laneSmoothers.bitDepth,
+                                                  snapshot[side ? ID::sideBitDepth : ID::bitDepth],
+                                                  snapshot[ID::envToBitDepth]));
+            bitCrusher.setSampleRateReduction(lane, modulate(laneSmoothers.sampleRate,
+                                                             snapshot[side ? ID::sideSampleRate : ID::sampleRate],
+                                                             snapshot[ID::envToSampleRate]));
+            radioEffect.setMix1(lane, modulate(laneSmoothers.radioMix1,
+                                               snapshot[side ? ID::sideRadioMix1 : ID::radioMix1],
+                                               snapshot[ID::envToRadioMix1]));
+            radioEffect.setMix2(lane, modulate(laneSmoothers.radioMix2,
+                                               snapshot[side ? ID::sideRadioMix2 : ID::radioMix2],
+                                               snapshot[ID::envToRadioMix2]));
+
+            intervalChannels[lane] = channels[lane] + start;
+        }
+
+        // M = (L + R) / 2 and S = (L - R) / 2, so decoding is a plain sum and difference
+        if (midSide)
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                float left = intervalChannels[0][i], right = intervalChannels[1][i];
+                intervalChannels[0][i] = (left + right) * 0.5f;
+                intervalChannels[1][i] = (left - right) * 0.5f;
+            }
+        }
 
         // Apply effects
-        bitCrusher.process(channelData, buffer.getNumSamples());
-        radioEffect.process(channelData, buffer.getNumSamples());
+        bitCrusher.process(intervalChannels, numChannels, length);
+        radioEffect.process(intervalChannels, numChannels, length);
+
+        if (midSide)
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                float mid = intervalChannels[0][i], side = intervalChannels[1][i];
+                intervalChannels[0][i] = mid + side;
+                intervalChannels[1][i] = mid - side;
+            }
+        }
+
+        start += length;
+        intervalPosition = (intervalPosition + length) % interval;
     }
 }
 
+#if RETROIZER_CLAP
+bool RetroizerAudioProcessor::supportsDirectEvent(uint16_t spaceId, uint16_t type)
+{
+    return spaceId == CLAP_CORE_EVENT_SPACE_ID && type == CLAP_EVENT_PARAM_VALUE;
+}
+
+void RetroizerAudioProcessor::handleDirectEvent(const clap_event_header_t* event, int sampleOffset)
+{
+    if (event->space_id != CLAP_CORE_EVENT_SPACE_ID || event->type != CLAP_EVENT_PARAM_VALUE)
+        return;
+
+    auto* paramEvent = reinterpret_cast<const clap_event_param_value_t*>(event);
+    const auto& allParameters = getParameters();
+    juce::AudioProcessorParameter* parameter = nullptr;
+
+    // The cookie is the wrapper's pointer to the parameter; it is only trusted when it
+    // matches one of ours, and the id is used when the host didn't pass it back
+    for (size_t i = 0; i < Parameters::numParameters && i < (size_t)allParameters.size(); ++i)
+    {
+        if (paramEvent->cookie == allParameters[(int)i] || (paramEvent->cookie == nullptr && paramEvent->param_id == clapParameterIds[i]))
+        {
+            parameter = allParameters[(int)i];
+            break;
+        }
+    }
+
+    if (parameter == nullptr)
+        return;
+
+    // The wrapper publishes parameters normalised to 0..1, so the value needs no conversion
+    ParameterEvent queued { juce::jmax(0, (int)event->time - sampleOffset), parameter, (float)paramEvent->value };
+
+    // When the queue is full the oldest event takes effect early to make room, so events for
+    // the same parameter still land in the order the host sent them
+    if (numParameterEvents == maxParameterEvents)
+    {
+        applyParameterEvent(parameterEvents[0]);
+        std::move(parameterEvents.begin() + 1, parameterEvents.begin() + numParameterEvents, parameterEvents.begin());
+        --numParameterEvents;
+    }
+
+    parameterEvents[(size_t)numParameterEvents++] = queued;
+}
+
+void RetroizerAudioProcessor::applyParameterEvent(const ParameterEvent& event)
+{
+    // Same as the wrapper does for events it handles itself: the APVTS value, which the
+    // snapshot reads, and the editor follow the host's value
+    if (event.parameter->getValue() != event.value)
+    {
+        event.parameter->setValue(event.value);
+        event.parameter->sendValueChangedMessageToListeners(event.value);
+        parameterEventsApplied = true;
+    }
+}
+#endif
+
 //==============================================================================
 bool RetroizerAudioProcessor::hasEditor() const
 {
@@ -156,41 +473,81 @@ juce::AudioProcessorEditor* RetroizerAudioProcessor::createEditor()
 //==============================================================================
 void RetroizerAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+    // Kept as XML so sessions still open in earlier versions. The startup benchmark times
+    // restoring this against a binary ValueTree, which setStateInformation() also reads.
+    std::unique_ptr<juce::XmlElement> xml(apvts.copyState().createXml());
     copyXmlToBinary(*xml, destData);
 }
 
 void RetroizerAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    // Sessions store the state as XML; a binary ValueTree is accepted too
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
-    if (xmlState.get() != nullptr)
-        apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    auto state = xmlState != nullptr ? juce::ValueTree::fromXml(*xmlState)
+                                     : juce::ValueTree::readFromData(data, (size_t)sizeInBytes);
+
+    if (state.isValid() && state.hasType(apvts.state.getType()))
+    {
+        apvts.replaceState(state);
+
+        // States saved before seeds were stored keep this instance's seed from now on
+        if (apvts.state.hasProperty("noiseSeed"))
+            noiseSeed = (juce::uint32)(int)apvts.state.getProperty("noiseSeed");
+        else
+            apvts.state.setProperty("noiseSeed", (int)noiseSeed.load(), nullptr);
+
+        // Hosts often restore the same state more than once while loading a session,
+        // so only hand the IR to the background loader when it actually changes. A state
+        // without an IR, or whose IR file has gone, must not keep the previous one playing.
+        auto irFile = getRadioImpulseResponseFile();
+
+        if (! irFile.existsAsFile())
+            irFile = juce::File();
+
+        if (irFile != loadedIRFile)
+        {
+            if (irFile == juce::File())
+                radioEffect.clearImpulseResponse();
+            else
+                radioEffect.loadImpulseResponse(irFile);
+
+            loadedIRFile = irFile;
+        }
+    }
 }
 
 //==============================================================================
-juce::AudioProcessorValueTreeState::ParameterLayout RetroizerAudioProcessor::createParameterLayout()
+void RetroizerAudioProcessor::loadRadioImpulseResponse(const juce::File& file)
 {
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    apvts.state.setProperty("irPath", file.getFullPathName(), nullptr);
+    radioEffect.loadImpulseResponse(file);
+    loadedIRFile = file;
+}
+
+juce::File RetroizerAudioProcessor::getRadioImpulseResponseFile() const
+{
+    auto path = apvts.state.getProperty("irPath").toString();
+    return path.isNotEmpty() ? juce::File(path) : juce::File();
+}
 
-    // Bit Crusher parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "bitDepth", "Bit Depth",
-        juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+RadioEffect::Quality RetroizerAudioProcessor::getQuality() const
+{
+    return (RadioEffect::Quality)governor.getLevel();
+}
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "sampleRate", "Sample Rate Reduction",
-        juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+float RetroizerAudioProcessor::getProcessingLoad() const
+{
+    return governor.getLoad();
+}
 
-    // Radio Effect parameters
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "radioMix1", "Radio Mix 1",
-        juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+//==============================================================================
+juce::AudioProcessorValueTreeState::ParameterLayout RetroizerAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        "radioMix2", "Radio Mix 2",
-        juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    for (const auto& descriptor : Parameters::descriptors)
+        layout.add(Parameters::createParameter(descriptor));
 
     return layout;
 }
@@ -3,8 +3,24 @@
 #include <JuceHeader.h>
 #include "BitCrusher.h"
 #include "RadioEffect.h"
+#include "EnvelopeFollower.h"
+#include "Parameters.h"
+#include "QualityGovernor.h"
+#include "ProcessingGrid.h"
+
+// Set by the CMake build when it adds the CLAP format through clap-juce-extensions
+#ifndef RETROIZER_CLAP
+ #define RETROIZER_CLAP 0
+#endif
+
+#if RETROIZER_CLAP
+ #include <clap-juce-extensions/clap-juce-extensions.h>
+#endif
 
 class RetroizerAudioProcessor : public juce::AudioProcessor
+#if RETROIZER_CLAP
+                              , public clap_juce_extensions::clap_juce_audio_processor_capabilities
+#endif
 {
 public:
     RetroizerAudioProcessor();
@@ -36,12 +52,93 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 #endif
 
+    // Loads an impulse response for the convolution mode of the radio stage and
+    // remembers its path in the plugin state
+    void loadRadioImpulseResponse(const juce::File& file);
+    juce::File getRadioImpulseResponseFile() const;
+
+    // Quality the radio stage currently runs at and the smoothed fraction of the block
+    // deadline spent processing by every instance in the process. Both can be read from any thread.
+    RadioEffect::Quality getQuality() const;
+    float getProcessingLoad() const;
+
+#if RETROIZER_CLAP
+    // CLAP parameter events are taken directly from the wrapper and applied at their
+    // sample position instead of once per block
+    bool supportsDirectEvent(uint16_t spaceId, uint16_t type) override;
+    void handleDirectEvent(const clap_event_header_t* event, int sampleOffset) override;
+#endif
+
     juce::AudioProcessorValueTreeState apvts;
 
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    // Runs the chain over part of a host block; processBlock() splits blocks at
+    // parameter events, if there are any
+    void processSegment(juce::AudioBuffer<float>& buffer);
+
+    Parameters::Sources parameters;
+    Parameters::Snapshot snapshot {};
+    bool snapshotNeedsRefresh = true;
+
+    // Set when a parameter event lands inside the current block, so the next segment
+    // re-reads the parameters even in the middle of a control interval
+    bool parameterEventsApplied = false;
+
+#if RETROIZER_CLAP
+    struct ParameterEvent
+    {
+        int sample;
+        juce::AudioProcessorParameter* parameter;
+        float value;
+    };
+
+    // Events for the coming block, filled by the wrapper just before processBlock() on
+    // the same thread. Anything past the capacity is applied at the start of the block.
+    static constexpr int maxParameterEvents = 512;
+    std::array<ParameterEvent, maxParameterEvents> parameterEvents;
+    int numParameterEvents = 0;
+
+    // Ids the wrapper gives each parameter, for hosts that don't pass the cookie back
+    std::array<juce::uint32, Parameters::numParameters> clapParameterIds {};
+
+    void applyParameterEvent(const ParameterEvent& event);
+#endif
+
+    // Position within the current control interval, carried across host blocks
+    int intervalPosition = 0;
+
+    // How the followers were last used; they are reset when that changes, since an idle
+    // follower holds a stale envelope
+    bool envelopeWasActive = false;
+    bool envelopeWasPerChannel = false;
+
     BitCrusher bitCrusher;
     RadioEffect radioEffect;
+    std::array<EnvelopeFollower, BitCrusher::maxChannels> envelopeFollowers;
+
+    // Steps the radio stage down when blocks get close to their deadline
+    QualityGovernor governor { RadioEffect::numQualities };
+
+    // Spec of the last full preparation, so unchanged re-preparations can be skipped
+    juce::dsp::ProcessSpec preparedSpec { 0.0, 0, 0 };
+    juce::File loadedIRFile;
+
+    // Written on the message thread when a state is loaded, read by the audio thread
+    std::atomic<juce::uint32> noiseSeed { 0 };
+
+    // Stereo: channels crush independently, each following its own envelope
+    // Linked: both channels share one envelope and one sample-and-hold clock
+    // Mid/Side: the chain runs on mid and side, optionally with separate side settings
+    enum class StereoMode { stereo, linked, midSide };
+
+    struct LaneSmoothers
+    {
+        juce::SmoothedValue<float> bitDepth, sampleRate, radioMix1, radioMix2;
+    };
+
+    std::array<LaneSmoothers, BitCrusher::maxChannels> smoothers;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RetroizerAudioProcessor)
 };
\ No newline at end of file
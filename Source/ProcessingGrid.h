@@ -0,0 +1,10 @@
+#pragma once
+
+// The fixed internal block size the whole chain runs in, whatever block size the host
+// passes. Every stage's working set for one interval stays in L1, parameters and envelopes
+// move once per interval, and all scratch space is sized for one interval. This is the one
+// knob for trading per-call overhead against modulation resolution.
+namespace ProcessingGrid
+{
+    constexpr int controlInterval = 64;
+}
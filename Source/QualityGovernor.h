@@ -0,0 +1,101 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SharedResources.h"
+
+// Watches how long each block takes against its real-time deadline and picks a quality
+// level for the next one: 0 is full quality, higher levels are progressively cheaper.
+// A host may run every instance on the same audio thread, so the levels follow the total
+// load of all instances in the process: a hundred instances at 1% each step down together
+// just like one instance at 100% would. It steps down quickly when the load stays high and only steps
+// back up after a sustained period of headroom, so it doesn't flap between levels. The
+// level and load are published through atomics and can be read from any thread.
+class QualityGovernor
+{
+public:
+    explicit QualityGovernor(int numberOfLevels) : numLevels(numberOfLevels) {}
+
+    ~QualityGovernor() { publish(0.0); }
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    // Also withdraws this instance's share of the total load, e.g. while adaptive quality is off
+    void reset()
+    {
+        smoothedLoad = 0.0;
+        secondsAtLevel = 0.0;
+        publish(0.0);
+        level.store(0, std::memory_order_relaxed);
+        load.store(0.0f, std::memory_order_relaxed);
+    }
+
+    // Call once per block with the time spent processing it
+    void update(double elapsedSeconds, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        double deadline = numSamples / sampleRate;
+        double blockLoad = elapsedSeconds / deadline;
+
+        // Rises within tens of milliseconds but falls slowly, so short dips don't count as headroom
+        double timeConstant = blockLoad > smoothedLoad ? 0.05 : 0.5;
+        smoothedLoad = blockLoad + std::exp(-deadline / timeConstant) * (smoothedLoad - blockLoad);
+        secondsAtLevel += deadline;
+
+        double total = publish(smoothedLoad);
+        int current = level.load(std::memory_order_relaxed);
+
+        if (total > stepDownLoad && current < numLevels - 1 && secondsAtLevel >= stepDownSeconds)
+            setLevel(current + 1);
+        else if (total < stepUpLoad && current > 0 && secondsAtLevel >= stepUpSeconds)
+            setLevel(current - 1);
+
+        load.store((float)total, std::memory_order_relaxed);
+    }
+
+    int getLevel() const { return level.load(std::memory_order_relaxed); }
+
+    // Smoothed fraction of the block deadline spent processing, summed over all instances
+    float getLoad() const { return load.load(std::memory_order_relaxed); }
+
+private:
+    void setLevel(int newLevel)
+    {
+        level.store(newLevel, std::memory_order_relaxed);
+        secondsAtLevel = 0.0;
+    }
+
+    // Replaces this instance's share of the process-wide total and returns the new total
+    double publish(double ownLoad)
+    {
+        auto share = (juce::int64)(ownLoad * 1.0e6);
+        auto total = sharedResources->getTotalLoad().fetch_add(share - publishedShare, std::memory_order_relaxed)
+                   + share - publishedShare;
+        publishedShare = share;
+        return (double)total * 1.0e-6;
+    }
+
+    // The gap between the thresholds is the hysteresis: a lower level has to run well
+    // under the step-up load before the more expensive one is tried again
+    static constexpr double stepDownLoad = 0.5;
+    static constexpr double stepUpLoad = 0.2;
+    static constexpr double stepDownSeconds = 0.1;
+    static constexpr double stepUpSeconds = 3.0;
+
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+
+    const int numLevels;
+    double sampleRate = 44100.0;
+    double smoothedLoad = 0.0;
+    double secondsAtLevel = 0.0;
+    juce::int64 publishedShare = 0;
+
+    std::atomic<int> level { 0 };
+    std::atomic<float> load { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE(QualityGovernor)
+};
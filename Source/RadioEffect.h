@@ -1,78 +1,362 @@
 #pragma once
 #include <JuceHeader.h>
+#include "SharedResources.h"
+#include "RadioNoise.h"
 
-class RadioEffect
+class RadioEffect : private SharedResources::ImpulseResponseClient
 {
 public:
+    enum class Mode { filters, convolution };
+
+    // Cheaper setting for when the CPU can't keep up: reduced replaces the convolution with
+    // the first band-pass and shares one noise lane between the channels
+    enum class Quality { full, reduced };
+    static constexpr int numQualities = 2;
+
+    // Size of the zero-latency head partition of the convolution engine
+    static constexpr int convolutionHeadSize = 128;
+
+    // Longer impulse responses are trimmed to keep the CPU cost bounded
+    static constexpr double maxImpulseResponseSeconds = 2.0;
+
+    // Switching between variants of the first stage is crossfaded over this long
+    static constexpr double crossfadeSeconds = 0.02;
+
+    // Both channels of a stereo pair are processed together, one SIMD lane each
+    static constexpr int maxChannels = 2;
+
     RadioEffect()
+        : convolution(juce::dsp::Convolution::NonUniform { convolutionHeadSize }, sharedResources->getConvolutionQueue())
     {
         updateFilter1(800.0f, 0.5f);
         updateFilter2(1200.0f, 0.7f);
     }
 
+    ~RadioEffect() override
+    {
+        sharedResources->cancelImpulseResponse(*this);
+    }
+
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate; // Added this line to set sampleRate
-        radioFilter1.prepare(spec);
-        radioFilter2.prepare(spec);
-        radioFilter1.reset();
-        radioFilter2.reset();
+        tempBuffer.setSize(maxChannels, (int)spec.maximumBlockSize);
+        fadeBuffer.setSize(maxChannels, (int)spec.maximumBlockSize);
+        crossfadeLength = juce::jmax(1, (int)(crossfadeSeconds * sampleRate));
 
         // Update filters with correct sample rate
         updateFilter1(800.0f, 0.5f);
         updateFilter2(1200.0f, 0.7f);
+
+        radioFilter1.prepare(spec);
+        radioFilter2.prepare(spec);
+
+        {
+            // Preparing posts a rebuild to the shared convolution queue, like a load does
+            const juce::ScopedLock sl(sharedResources->getLoaderLock());
+            convolution.prepare({ spec.sampleRate, spec.maximumBlockSize, (juce::uint32)maxChannels });
+        }
+
+        noise.prepare(spec);
+
+        // The shared copy of the impulse response is resampled for one rate only
+        if (impulseResponseFile != juce::File())
+            loadImpulseResponse(impulseResponseFile);
+
+        reset();
     }
 
-    void process(float* buffer, int numSamples)
+    void reset()
     {
-        if (mix1 == 0.0f && mix2 == 0.0f) return;
+        radioFilter1.reset();
+        radioFilter2.reset();
+        convolution.reset();
+        noise.reset();
+        fadeSamplesRemaining = 0;
+        stage1Idle = stage2Idle = true;
+    }
 
-        juce::AudioBuffer<float> tempBuffer(1, numSamples);
-        tempBuffer.copyFrom(0, 0, buffer, numSamples);
+    void process(float* const* channels, int numChannels, int numSamples)
+    {
+        numChannels = juce::jmin(numChannels, maxChannels);
 
-        if (mix1 > 0.0f)
-        {
-            juce::dsp::AudioBlock<float> block(tempBuffer);
-            juce::dsp::ProcessContextReplacing<float> context(block);
-            radioFilter1.process(context);
+        // Nothing of the first stage is audible while its mix is off, so there is nothing to fade
+        if (isSilent(mix1))
+            fadeSamplesRemaining = 0;
 
-            for (int i = 0; i < numSamples; ++i)
-                buffer[i] = buffer[i] * (1.0f - mix1) + tempBuffer.getSample(0, i) * mix1;
+        // A stage isn't fed while its mix is off, so its history is stale by the time the mix
+        // comes back. Clear it then, or the convolution would replay up to 2 s of old audio.
+        // The mix ramps up from 0, so the cleared state fades in without a click.
+        if (stage1Idle && ! isSilent(mix1))
+        {
+            if (activeStage == Stage::convolution)
+                convolution.reset();
+            else
+                radioFilter1.reset();
         }
 
-        if (mix2 > 0.0f)
+        if (stage2Idle && ! isSilent(mix2))
+            radioFilter2.reset();
+
+        stage1Idle = isSilent(mix1);
+        stage2Idle = isSilent(mix2);
+
+        if (isSilent(mix1) && isSilent(mix2) && ! noise.isActive()) return;
+
+        // Noise is added in the first per-sample pass over the audio, so that the
+        // band-passes colour it like the rest of the signal
+        const float* const* pendingNoise = noise.isActive() ? noise.process(channels, numChannels, numSamples)
+                                                            : nullptr;
+
+        if (! isSilent(mix1))
         {
-            tempBuffer.copyFrom(0, 0, buffer, numSamples); // Reset temp buffer
-            juce::dsp::AudioBlock<float> block(tempBuffer);
-            juce::dsp::ProcessContextReplacing<float> context(block);
-            radioFilter2.process(context);
+            if (fadeSamplesRemaining > 0)
+                processCrossfade(channels, numChannels, numSamples, pendingNoise);
+            else
+                processStage(activeStage, channels, numChannels, numSamples, pendingNoise);
 
-            for (int i = 0; i < numSamples; ++i)
-                buffer[i] = buffer[i] * (1.0f - mix2) + tempBuffer.getSample(0, i) * mix2;
+            pendingNoise = nullptr;
+        }
+
+        if (! isSilent(mix2))
+        {
+            processFilter(radioFilter2, mix2, channels, numChannels, numSamples, pendingNoise);
+            pendingNoise = nullptr;
         }
+
+        if (pendingNoise != nullptr)
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::add(channels[channel], pendingNoise[channel], numSamples);
     }
 
+    // Coefficients come from the process-wide cache and are shared with every other
+    // instance at the same sample rate, so they must never be modified in place
     void updateFilter1(float freq, float q)
     {
-        *radioFilter1.state = juce::dsp::IIR::ArrayCoefficients<float>::makeBandPass(
-            sampleRate, freq, q);
+        radioFilter1.coefficients = sharedResources->getBandPass(sampleRate, freq, q);
     }
 
     void updateFilter2(float freq, float q)
     {
-        *radioFilter2.state = juce::dsp::IIR::ArrayCoefficients<float>::makeBandPass(
-            sampleRate, freq, q);
+        radioFilter2.coefficients = sharedResources->getBandPass(sampleRate, freq, q);
     }
 
-    void setMix1(float newMix) { mix1 = newMix; }
-    void setMix2(float newMix) { mix2 = newMix; }
+    // Call from the message thread; audio may keep running and returns straight away. The
+    // file is read and resampled once per process on the SharedResources decoding thread,
+    // and every instance using it gets a copy to partition on the shared convolution thread,
+    // swapped in without allocating on the audio thread.
+    void loadImpulseResponse(const juce::File& file)
+    {
+        impulseResponseFile = file;
+        sharedResources->requestImpulseResponse(*this, file, sampleRate, maxImpulseResponseSeconds);
+    }
+
+    // Goes back to passing the signal through the convolution unchanged, as before any
+    // impulse response was loaded
+    void clearImpulseResponse()
+    {
+        impulseResponseFile = juce::File();
+        sharedResources->cancelImpulseResponse(*this);
+
+        const juce::ScopedLock sl(sharedResources->getLoaderLock());
+        impulseResponse = nullptr;
+
+        juce::AudioBuffer<float> unitImpulse(1, 1);
+        unitImpulse.setSample(0, 0, 1.0f);
+        convolution.loadImpulseResponse(std::move(unitImpulse), sampleRate,
+                                        juce::dsp::Convolution::Stereo::no,
+                                        juce::dsp::Convolution::Trim::no,
+                                        juce::dsp::Convolution::Normalise::no);
+    }
+
+    void setMode(Mode newMode)
+    {
+        mode = newMode;
+        updateStage();
+    }
+
+    void setQuality(Quality newQuality)
+    {
+        if (newQuality != quality)
+        {
+            quality = newQuality;
+            noise.setSharedLanes(quality != Quality::full, crossfadeLength);
+            updateStage();
+        }
+    }
+
+    RadioNoise& getNoise() { return noise; }
+
+    // Length in samples of the impulse response the convolution currently runs
+    int getImpulseResponseSize() const { return convolution.getCurrentIRSize(); }
+
+    void setMix1(int channel, float newMix) { mix1[channel] = newMix; }
+    void setMix2(int channel, float newMix) { mix2[channel] = newMix; }
 
 private:
-    juce::dsp::ProcessorDuplicator<
-        juce::dsp::IIR::Filter<float>,
-        juce::dsp::IIR::Coefficients<float>> radioFilter1, radioFilter2;
+    using Lanes = juce::dsp::SIMDRegister<float>;
+
+    // The variants the first stage can run as
+    enum class Stage { bandPass, convolution };
+
+    void impulseResponseReady(SharedResources::ImpulseResponse::Ptr newImpulseResponse) override
+    {
+        impulseResponse = newImpulseResponse;
+
+        juce::AudioBuffer<float> engineCopy(impulseResponse->buffer);
+        convolution.loadImpulseResponse(std::move(engineCopy), impulseResponse->sampleRate,
+                                        juce::dsp::Convolution::Stereo::no,
+                                        juce::dsp::Convolution::Trim::yes,
+                                        juce::dsp::Convolution::Normalise::yes);
+    }
+
+    static bool isSilent(const float (&mix)[maxChannels]) { return mix[0] == 0.0f && mix[1] == 0.0f; }
+
+    void updateStage()
+    {
+        // In convolution mode the loaded impulse response replaces the first band-pass,
+        // unless the quality has been lowered
+        auto newStage = Stage::bandPass;
+
+        if (mode == Mode::convolution && quality == Quality::full)
+            newStage = Stage::convolution;
+
+        if (newStage != activeStage)
+        {
+            // Clear the tail of the stage being switched in so stale state doesn't ring out,
+            // then fade over from the stage being switched out
+            if (newStage == Stage::convolution)
+                convolution.reset();
+            else
+                radioFilter1.reset();
+
+            fadingStage = activeStage;
+            activeStage = newStage;
+            fadeSamplesRemaining = crossfadeLength;
+        }
+    }
+
+    void processStage(Stage stage, float* const* channels, int numChannels, int numSamples,
+                      const float* const* noiseToAdd)
+    {
+        if (stage == Stage::convolution)
+            processConvolution(channels, numChannels, numSamples, noiseToAdd);
+        else
+            processFilter(radioFilter1, mix1, channels, numChannels, numSamples, noiseToAdd);
+    }
+
+    // Runs the outgoing and incoming first stage side by side and blends linearly from
+    // one to the other. Both only run together for the length of the fade.
+    void processCrossfade(float* const* channels, int numChannels, int numSamples, const float* const* noiseToAdd)
+    {
+        jassert(numSamples <= fadeBuffer.getNumSamples());
+
+        float* fadeChannels[maxChannels] = {};
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (noiseToAdd != nullptr)
+                juce::FloatVectorOperations::add(channels[channel], noiseToAdd[channel], numSamples);
+
+            fadeBuffer.copyFrom(channel, 0, channels[channel], numSamples);
+            fadeChannels[channel] = fadeBuffer.getWritePointer(channel);
+        }
+
+        processStage(fadingStage, fadeChannels, numChannels, numSamples, nullptr);
+        processStage(activeStage, channels, numChannels, numSamples, nullptr);
+
+        int fadeSamples = juce::jmin(numSamples, fadeSamplesRemaining);
+        float fadeStep = 1.0f / (float)crossfadeLength;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float outgoing = (float)fadeSamplesRemaining * fadeStep;
+
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                channels[channel][i] += (fadeChannels[channel][i] - channels[channel][i]) * outgoing;
+                outgoing -= fadeStep;
+            }
+        }
+
+        fadeSamplesRemaining -= fadeSamples;
+    }
+
+    // Runs one band-pass over the pair with left and right packed into the lanes of a
+    // single register, so both channels cost one biquad evaluation per sample
+    void processFilter(juce::dsp::IIR::Filter<Lanes>& filter, const float (&mix)[maxChannels],
+                       float* const* channels, int numChannels, int numSamples, const float* const* noiseToAdd)
+    {
+        alignas(Lanes::SIMDRegisterSize) float mixLanes[Lanes::SIMDNumElements] = { mix[0], mix[1] };
+        alignas(Lanes::SIMDRegisterSize) float lanes[Lanes::SIMDNumElements] = {};
+        auto wetMix = Lanes::fromRawArray(mixLanes);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                lanes[channel] = noiseToAdd != nullptr ? channels[channel][i] + noiseToAdd[channel][i]
+                                                       : channels[channel][i];
+
+            auto dry = Lanes::fromRawArray(lanes);
+            auto wet = filter.processSample(dry);
+            (dry + (wet - dry) * wetMix).copyToRawArray(lanes);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                channels[channel][i] = lanes[channel];
+        }
+    }
+
+    void processConvolution(float* const* channels, int numChannels, int numSamples, const float* const* noiseToAdd)
+    {
+        // Scratch space is allocated in prepare() and must never grow on the audio thread
+        jassert(numSamples <= tempBuffer.getNumSamples());
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (noiseToAdd != nullptr)
+                juce::FloatVectorOperations::add(channels[channel], noiseToAdd[channel], numSamples);
+
+            tempBuffer.copyFrom(channel, 0, channels[channel], numSamples);
+        }
+
+        auto block = juce::dsp::AudioBlock<float>(tempBuffer)
+                         .getSubsetChannelBlock(0, (size_t)numChannels)
+                         .getSubBlock(0, (size_t)numSamples);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        convolution.process(context);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* wet = tempBuffer.getReadPointer(channel);
+
+            for (int i = 0; i < numSamples; ++i)
+                channels[channel][i] = channels[channel][i] * (1.0f - mix1[channel]) + wet[i] * mix1[channel];
+        }
+    }
+
+    // Declared first, since the convolution engines are constructed with its message queue
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+
+    juce::dsp::IIR::Filter<Lanes> radioFilter1, radioFilter2;
+
+    juce::dsp::Convolution convolution;
+    SharedResources::ImpulseResponse::Ptr impulseResponse; // Guarded by the loader lock
+    juce::File impulseResponseFile;
+    Mode mode = Mode::filters;
+    Quality quality = Quality::full;
+
+    Stage activeStage = Stage::bandPass, fadingStage = Stage::bandPass;
+    int fadeSamplesRemaining = 0;
+    int crossfadeLength = 1;
+
+    // Whether each stage sat out the previous call because its mix was off
+    bool stage1Idle = true, stage2Idle = true;
+
+    RadioNoise noise;
+
+    juce::AudioBuffer<float> tempBuffer, fadeBuffer;
 
-    float mix1 = 0.0f;
-    float mix2 = 0.0f;
+    float mix1[maxChannels] = { 0.0f, 0.0f };
+    float mix2[maxChannels] = { 0.0f, 0.0f };
     double sampleRate = 44100.0;
 };
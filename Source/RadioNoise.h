@@ -0,0 +1,263 @@
+#pragma once
+#include <JuceHeader.h>
+#include "SharedResources.h"
+
+// Static, crackle and mains hum for the radio stage. The random source is a counter-based
+// hash rather than a stateful generator: random value n of lane l is hash(n ^ key(l)), so the
+// lanes are independent, no random value depends on the previous one, and a render started
+// from reset() with the same seed is bit-identical.
+class RadioNoise
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    RadioNoise() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        // One channel per lane plus scratch space for the crackle impulses
+        noiseBuffer.setSize(maxChannels + 1, (int)spec.maximumBlockSize);
+
+        // Static is white noise through a one-pole low-pass, like hiss behind a small speaker
+        staticCoeff = 1.0f - (float)std::exp(-juce::MathConstants<double>::twoPi * 3500.0 / sampleRate);
+        crackleDecay = (float)std::exp(-1.0 / (0.0004 * sampleRate));
+        levelReleaseSamples = (float)(0.15 * sampleRate);
+        fullChunkRelease = std::exp(-(float)spec.maximumBlockSize / levelReleaseSamples);
+
+        humTable = sharedResources->get<HumTable>("humTable", 0.0, [] { return new HumTable(); });
+
+        setHumFrequency(humFrequency);
+        setCrackle(crackleLevel);
+        reset();
+    }
+
+    void reset()
+    {
+        counter = 0;
+        humPhase = 0.0f;
+        inputLevel = 0.0f;
+        laneFadeRemaining = 0;
+
+        for (int lane = 0; lane < maxChannels; ++lane)
+        {
+            staticState[lane] = 0.0f;
+            crackleState[lane] = 0.0f;
+        }
+    }
+
+    void setSeed(juce::uint32 newSeed) { seed = newSeed; }
+
+    void setStatic(float level) { staticLevel = level * 0.1f; }
+
+    void setCrackle(float level)
+    {
+        // Up to 40 clicks per second per channel, louder as they get denser
+        crackleLevel = level;
+        crackleThreshold = (juce::uint32)juce::jmin(4294967295.0, level * 40.0 / sampleRate * 4294967296.0);
+    }
+
+    void setHum(float level) { humLevel = level * 0.05f; }
+
+    void setHumFrequency(float hz)
+    {
+        humFrequency = hz;
+        humIncrement = (float)(HumTable::size * hz / sampleRate);
+    }
+
+    // 0 keeps the noise constant, 1 gates it completely with the input level
+    void setFollow(float amount) { follow = amount; }
+
+    // Economy mode generates a single noise lane and feeds it to both channels. The second
+    // channel crossfades between its own lane and the shared one over fadeLength samples,
+    // and its lane keeps running until the fade is over.
+    void setSharedLanes(bool shouldShareLanes, int fadeLength)
+    {
+        if (shouldShareLanes != sharedLanes)
+        {
+            sharedLanes = shouldShareLanes;
+            laneFadeLength = juce::jmax(1, fadeLength);
+            laneFadeRemaining = laneFadeLength;
+        }
+    }
+
+    bool isActive() const { return staticLevel > 0.0f || crackleLevel > 0.0f || humLevel > 0.0f; }
+
+    // Generates one chunk of noise for the given input into internal scratch space and
+    // returns it, so the caller can add it in whichever pass over the audio it makes first
+    const float* const* process(const float* const* input, int numChannels, int numSamples)
+    {
+        jassert(numSamples <= noiseBuffer.getNumSamples());
+        numChannels = juce::jmin(numChannels, maxChannels);
+
+        // The input level is only tracked per chunk, which is plenty for a noise gate
+        float peak = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax(input[channel], numSamples);
+            peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        }
+
+        // Calls can be shorter than a full interval, so a partial one scales the release to its length
+        float release = numSamples == noiseBuffer.getNumSamples() ? fullChunkRelease
+                                                                  : std::exp(-(float)numSamples / levelReleaseSamples);
+        inputLevel = peak > inputLevel ? peak : inputLevel * release;
+        float gain = 1.0f - follow + follow * juce::jmin(1.0f, inputLevel * 4.0f);
+
+        auto* humSamples = humTable->samples.data();
+        float crackleAmount = 0.3f + 0.7f * crackleLevel;
+
+        auto* impulses = noiseBuffer.getWritePointer(maxChannels);
+        bool fadingLanes = laneFadeRemaining > 0 && numChannels == maxChannels;
+        int numLanes = sharedLanes && ! fadingLanes ? 1 : numChannels;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto* out = noiseBuffer.getWritePointer(lane);
+            auto staticKey = seed ^ (0x9e3779b9u * (juce::uint32)(2 * lane + 1));
+            auto crackleKey = seed ^ (0x85ebca6bu * (juce::uint32)(2 * lane + 2));
+
+            // The random values have no dependency between samples, so this loop vectorizes as
+            // long as it has no branches: the crackle select multiplies by a 0/1 mask instead
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto n = counter + (juce::uint32)i;
+                out[i] = toBipolar(hash(n ^ staticKey));
+                float isCrackle = (float)(hash(n ^ crackleKey) < crackleThreshold);
+                impulses[i] = out[i] * crackleAmount * isCrackle;
+            }
+
+            float phase = humPhase;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                staticState[lane] += staticCoeff * (out[i] - staticState[lane]);
+                crackleState[lane] = crackleState[lane] * crackleDecay + impulses[i];
+
+                // Hum is the same on both channels, read from the shared one-cycle table
+                int index = (int)phase;
+                float frac = phase - (float)index;
+                float hum = humSamples[index] + frac * (humSamples[index + 1] - humSamples[index]);
+                phase += humIncrement;
+                phase = phase >= (float)HumTable::size ? phase - (float)HumTable::size : phase;
+
+                out[i] = gain * (staticLevel * staticState[lane] + crackleState[lane] + humLevel * hum);
+            }
+
+            if (lane == numLanes - 1)
+                humPhase = phase;
+        }
+
+        counter += (juce::uint32)numSamples;
+
+        if (fadingLanes)
+            fadeSecondLane(numSamples);
+
+        laneFadeRemaining = fadingLanes ? laneFadeRemaining : 0;
+
+        for (int lane = 0; lane < maxChannels; ++lane)
+            lanePointers[lane] = noiseBuffer.getReadPointer(sharedLanes && ! fadingLanes ? 0 : lane);
+
+        return lanePointers;
+    }
+
+private:
+    // Blends the second lane towards the shared one when sharing starts, and back towards its
+    // own noise when sharing ends. After the fade the second lane is only generated if unshared.
+    void fadeSecondLane(int numSamples)
+    {
+        auto* shared = noiseBuffer.getReadPointer(0);
+        auto* own = noiseBuffer.getWritePointer(1);
+
+        int fadeSamples = juce::jmin(numSamples, laneFadeRemaining);
+        float fadeStep = 1.0f / (float)laneFadeLength;
+        float remaining = (float)laneFadeRemaining * fadeStep;
+
+        for (int i = 0; i < fadeSamples; ++i)
+        {
+            float ownWeight = sharedLanes ? remaining : 1.0f - remaining;
+            own[i] = shared[i] + (own[i] - shared[i]) * ownWeight;
+            remaining -= fadeStep;
+        }
+
+        if (sharedLanes)
+            for (int i = fadeSamples; i < numSamples; ++i)
+                own[i] = shared[i];
+
+        laneFadeRemaining -= fadeSamples;
+    }
+
+    // One cycle of mains hum: a weak fundamental under the stronger rectifier harmonics.
+    // Built once per process and shared by every instance through SharedResources.
+    struct HumTable : public juce::ReferenceCountedObject
+    {
+        static constexpr int size = 1024;
+
+        HumTable()
+        {
+            const float weights[] = { 0.6f, 1.0f, 0.4f, 0.25f, 0.15f };
+            float peak = 0.0f;
+
+            for (int i = 0; i <= size; ++i)
+            {
+                float sample = 0.0f;
+
+                for (int harmonic = 0; harmonic < 5; ++harmonic)
+                    sample += weights[harmonic] * std::sin(juce::MathConstants<float>::twoPi * (float)((harmonic + 1) * i) / (float)size);
+
+                samples[(size_t)i] = sample;
+                peak = juce::jmax(peak, std::abs(sample));
+            }
+
+            for (auto& sample : samples)
+                sample /= peak;
+        }
+
+        // One extra sample so interpolation never has to wrap
+        std::array<float, size + 1> samples;
+    };
+
+    // lowbias32 integer hash (Wellons), a full-avalanche 32-bit mix
+    static juce::uint32 hash(juce::uint32 x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    static float toBipolar(juce::uint32 x) { return (float)(juce::int32)x * (1.0f / 2147483648.0f); }
+
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+    juce::ReferenceCountedObjectPtr<HumTable> humTable;
+    juce::AudioBuffer<float> noiseBuffer;
+    const float* lanePointers[maxChannels] = {};
+
+    juce::uint32 seed = 0x5eed1234u;
+    juce::uint32 counter = 0;
+    juce::uint32 crackleThreshold = 0;
+
+    float staticLevel = 0.0f;
+    float crackleLevel = 0.0f;
+    float humLevel = 0.0f;
+    float humFrequency = 50.0f;
+    float follow = 0.0f;
+    bool sharedLanes = false;
+    int laneFadeLength = 1;
+    int laneFadeRemaining = 0;
+
+    float staticCoeff = 1.0f;
+    float crackleDecay = 0.0f;
+    float levelReleaseSamples = 1.0f;
+    float fullChunkRelease = 0.0f;
+    float humIncrement = 0.0f;
+    float humPhase = 0.0f;
+    float inputLevel = 0.0f;
+
+    float staticState[maxChannels] = { 0.0f, 0.0f };
+    float crackleState[maxChannels] = { 0.0f, 0.0f };
+    double sampleRate = 44100.0;
+};
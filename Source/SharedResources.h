@@ -0,0 +1,230 @@
+#pragma once
+#include <JuceHeader.h>
+#include "DSPCore.h"
+
+// Process-wide cache of immutable DSP resources (filter coefficients, tables, impulse responses, ...).
+// Hold it through juce::SharedResourcePointer<SharedResources> so all plugin instances
+// share one copy. Lookups lock and may build, so call them from prepareToPlay() or the
+// message thread only; the returned pointers are read-only and safe to use on the
+// audio thread without locking. Impulse responses are decoded on a background thread.
+class SharedResources
+{
+public:
+    SharedResources() = default;
+
+    template <typename ResourceType, typename Builder>
+    juce::ReferenceCountedObjectPtr<ResourceType> get(const juce::String& resourceId, double sampleRate, Builder&& build)
+    {
+        const juce::ScopedLock sl(lock);
+
+        auto key = std::make_pair(resourceId, sampleRate);
+        auto it = resources.find(key);
+
+        if (it != resources.end())
+            return dynamic_cast<ResourceType*>(it->second.get());
+
+        purgeUnused();
+
+        juce::ReferenceCountedObjectPtr<ResourceType> resource(build());
+
+        if (resource != nullptr)
+            resources[key] = resource.get();
+
+        return resource;
+    }
+
+    juce::dsp::IIR::Coefficients<float>::Ptr getBandPass(double sampleRate, float frequency, float q)
+    {
+        return get<juce::dsp::IIR::Coefficients<float>>(
+            "bandPass:" + juce::String(frequency) + ":" + juce::String(q), sampleRate,
+            [=]
+            {
+                auto c = DSPCore::designBandPass(sampleRate, frequency, q);
+                return new juce::dsp::IIR::Coefficients<float>(c.b0, 0.0f, c.b2, 1.0f, c.a1, c.a2);
+            });
+    }
+
+    // A decoded impulse response, already resampled to the rate it is used at. Entries are
+    // cached as soon as they are requested and filled in by the decoding thread.
+    struct ImpulseResponse : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<ImpulseResponse>;
+
+        juce::AudioBuffer<float> buffer;
+        double sampleRate = 0.0;
+        bool ready = false; // Guarded by the loader lock
+    };
+
+    // Something waiting for an impulse response, e.g. one radio stage
+    class ImpulseResponseClient
+    {
+    public:
+        virtual ~ImpulseResponseClient() = default;
+
+        // Called once the impulse response is decoded, on the decoding thread or on the
+        // requesting one if it was already cached, always with the loader lock held
+        virtual void impulseResponseReady(ImpulseResponse::Ptr impulseResponse) = 0;
+    };
+
+    // Reads, trims and resamples an impulse response file once per file and sample rate, on
+    // a background thread, and hands it to the client when done. A later request or cancel
+    // from the same client replaces this one. Files that can't be read are never delivered.
+    void requestImpulseResponse(ImpulseResponseClient& client, const juce::File& file, double sampleRate, double maxSeconds)
+    {
+        bool isNew = false;
+
+        // The modification time is part of the key, so an edited file is read again
+        auto impulseResponse = get<ImpulseResponse>(
+            "impulseResponse:" + file.getFullPathName() + ":" + juce::String(file.getLastModificationTime().toMilliseconds())
+                + ":" + juce::String(maxSeconds),
+            sampleRate,
+            [&isNew] { isNew = true; return new ImpulseResponse(); });
+
+        {
+            const juce::ScopedLock sl(loaderLock);
+
+            if (impulseResponse->ready)
+            {
+                waitingClients.erase(&client);
+                client.impulseResponseReady(impulseResponse);
+            }
+            else
+            {
+                waitingClients[&client] = impulseResponse;
+            }
+        }
+
+        // Decoding takes a while for long files, so it runs outside both locks and other
+        // instances can keep looking up their resources meanwhile
+        if (isNew)
+        {
+            decoder.addJob([this, impulseResponse, file, sampleRate, maxSeconds]
+            {
+                juce::AudioBuffer<float> decoded;
+                bool succeeded = readImpulseResponse(file, sampleRate, maxSeconds, decoded);
+
+                if (! succeeded)
+                    remove(impulseResponse.get());
+
+                const juce::ScopedLock sl(loaderLock);
+
+                if (succeeded)
+                {
+                    impulseResponse->buffer = std::move(decoded);
+                    impulseResponse->sampleRate = sampleRate;
+                    impulseResponse->ready = true;
+                }
+
+                for (auto it = waitingClients.begin(); it != waitingClients.end();)
+                {
+                    if (it->second != impulseResponse)
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    if (succeeded)
+                        it->first->impulseResponseReady(impulseResponse);
+
+                    it = waitingClients.erase(it);
+                }
+            });
+        }
+    }
+
+    // Forgets any request the client has pending; call before it is destroyed
+    void cancelImpulseResponse(ImpulseResponseClient& client)
+    {
+        const juce::ScopedLock sl(loaderLock);
+        waitingClients.erase(&client);
+    }
+
+    // The convolution queue takes impulse responses from one thread at a time, so every load
+    // into an engine that uses it must hold this lock
+    const juce::CriticalSection& getLoaderLock() const { return loaderLock; }
+
+    // One background thread loads impulse responses for every convolution engine in the
+    // process, instead of each engine starting its own
+    juce::dsp::ConvolutionMessageQueue& getConvolutionQueue() { return convolutionQueue; }
+
+    // Sum of every instance's processing load, in millionths of a block deadline. Each quality
+    // governor adds its own share, so all of them react to the load of the whole process.
+    std::atomic<juce::int64>& getTotalLoad() { return totalLoad; }
+
+private:
+    static bool readImpulseResponse(const juce::File& file, double sampleRate, double maxSeconds, juce::AudioBuffer<float>& result)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+        if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+            return false;
+
+        auto length = (int)juce::jmin(reader->lengthInSamples, (juce::int64)(maxSeconds * reader->sampleRate));
+
+        juce::AudioBuffer<float> source(1, length);
+        reader->read(&source, 0, length, 0, true, false);
+
+        if (reader->sampleRate == sampleRate)
+        {
+            result = std::move(source);
+            return true;
+        }
+
+        // Resampled the way JUCE's own loader does it: the source is low-passed before it is
+        // decimated, so an impulse response recorded at a higher rate doesn't alias
+        auto ratio = reader->sampleRate / sampleRate;
+        auto resampledLength = juce::jmax(1, (int)(length / ratio));
+
+        juce::MemoryAudioSource memorySource(source, false);
+        juce::ResamplingAudioSource resampler(&memorySource, false, 1);
+        resampler.setResamplingRatio(ratio);
+        resampler.prepareToPlay(resampledLength, sampleRate);
+
+        result.setSize(1, resampledLength);
+        resampler.getNextAudioBlock(juce::AudioSourceChannelInfo(&result, 0, resampledLength));
+        return true;
+    }
+
+    void remove(const juce::ReferenceCountedObject* resource)
+    {
+        const juce::ScopedLock sl(lock);
+
+        for (auto it = resources.begin(); it != resources.end(); ++it)
+        {
+            if (it->second.get() == resource)
+            {
+                resources.erase(it);
+                return;
+            }
+        }
+    }
+
+    // Drops resources that no instance refers to any more, e.g. after a sample rate change
+    void purgeUnused()
+    {
+        for (auto it = resources.begin(); it != resources.end();)
+        {
+            if (it->second->getReferenceCount() == 1)
+                it = resources.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    juce::dsp::ConvolutionMessageQueue convolutionQueue;
+    std::atomic<juce::int64> totalLoad { 0 };
+
+    juce::CriticalSection lock;
+    std::map<std::pair<juce::String, double>, juce::ReferenceCountedObjectPtr<juce::ReferenceCountedObject>> resources;
+
+    juce::CriticalSection loaderLock;
+    std::map<ImpulseResponseClient*, ImpulseResponse::Ptr> waitingClients;
+
+    // Declared last so it is destroyed first, finishing any decode before the rest goes
+    juce::ThreadPool decoder { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE(SharedResources)
+};
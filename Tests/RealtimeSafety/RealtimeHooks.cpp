@@ -0,0 +1,414 @@
+#include "RealtimeHooks.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int maxFrames = 8;
+    constexpr int maxSites = 256;
+
+    struct CallSite
+    {
+        const char* function;
+        void* frames[maxFrames];
+        int numFrames;
+        int count;
+    };
+
+    thread_local bool inRealtimeSection = false;
+    thread_local bool recording = false;
+
+    // Only touched by the thread inside the real-time section, and read after it has left
+    CallSite callSites[maxSites];
+    int numCallSites = 0;
+    int numViolations = 0;
+
+    // Never inlined, so the hooked call's caller is always two frames up
+    __attribute__((noinline)) void recordViolation(const char* function)
+    {
+        if (! inRealtimeSection || recording)
+            return;
+
+        recording = true;
+        ++numViolations;
+
+        void* stack[maxFrames + 2];
+        int depth = backtrace(stack, maxFrames + 2);
+        void** frames = stack + 2;
+        int numFrames = depth > 2 ? depth - 2 : 0;
+
+        CallSite* site = nullptr;
+
+        for (int i = 0; i < numCallSites && site == nullptr; ++i)
+        {
+            auto& candidate = callSites[i];
+
+            if (candidate.function == function && candidate.numFrames == numFrames
+                && std::memcmp(candidate.frames, frames, sizeof(void*) * (size_t)numFrames) == 0)
+                site = &candidate;
+        }
+
+        if (site == nullptr && numCallSites < maxSites)
+        {
+            site = &callSites[numCallSites++];
+            site->function = function;
+            site->numFrames = numFrames;
+            site->count = 0;
+            std::memcpy(site->frames, frames, sizeof(void*) * (size_t)numFrames);
+        }
+
+        if (site != nullptr)
+            ++site->count;
+
+        recording = false;
+    }
+
+    void printFrame(void* address)
+    {
+        Dl_info info {};
+
+        if (dladdr(address, &info) == 0)
+        {
+            std::printf("      %p\n", address);
+            return;
+        }
+
+        auto* module = info.dli_fname != nullptr ? std::strrchr(info.dli_fname, '/') : nullptr;
+        module = module != nullptr ? module + 1 : info.dli_fname;
+
+        if (info.dli_sname != nullptr)
+        {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::printf("      %s+0x%lx (%s)\n", status == 0 ? demangled : info.dli_sname,
+                        (unsigned long)((char*)address - (char*)info.dli_saddr), module);
+            std::free(demangled);
+        }
+        else
+        {
+            // Resolve with: addr2line -f -C -e <module> <offset>
+            std::printf("      %s+0x%lx\n", module, (unsigned long)((char*)address - (char*)info.dli_fbase));
+        }
+    }
+}
+
+namespace RealtimeHooks
+{
+    void initialise()
+    {
+        // The first backtrace() loads the unwinder, which allocates
+        void* frames[2];
+        backtrace(frames, 2);
+    }
+
+    ScopedRealtimeSection::ScopedRealtimeSection() { inRealtimeSection = true; }
+    ScopedRealtimeSection::~ScopedRealtimeSection() { inRealtimeSection = false; }
+
+    int getNumViolations() { return numViolations; }
+
+    int getNumCalls(const char* function)
+    {
+        int calls = 0;
+
+        for (int i = 0; i < numCallSites; ++i)
+            if (std::strcmp(callSites[i].function, function) == 0)
+                calls += callSites[i].count;
+
+        return calls;
+    }
+
+    void reset()
+    {
+        numCallSites = 0;
+        numViolations = 0;
+    }
+
+    void printReport()
+    {
+        std::printf("%d real-time violation(s) at %d call site(s)\n", numViolations, numCallSites);
+
+        for (int i = 0; i < numCallSites; ++i)
+        {
+            std::printf("  %s, %d call(s)\n", callSites[i].function, callSites[i].count);
+
+            for (int frame = 0; frame < callSites[i].numFrames; ++frame)
+                printFrame(callSites[i].frames[frame]);
+        }
+    }
+}
+
+//==============================================================================
+// The --wrap=<name> link options route every call to <name> in the tool's own objects
+// (the processor and the JUCE modules) to __wrap_<name>; __real_<name> is the original.
+// glibc headers redirect some calls to other symbols: open, fopen and mmap to their 64-bit
+// versions under _FILE_OFFSET_BITS=64, and read and open to checked versions under
+// _FORTIFY_SOURCE. Those are hooked too, or the calls would slip past.
+extern "C"
+{
+    void* __real_malloc(size_t);
+    void* __real_calloc(size_t, size_t);
+    void* __real_realloc(void*, size_t);
+    void __real_free(void*);
+    int __real_posix_memalign(void**, size_t, size_t);
+    void* __real_aligned_alloc(size_t, size_t);
+
+    int __real_pthread_mutex_lock(pthread_mutex_t*);
+    int __real_pthread_cond_wait(pthread_cond_t*, pthread_mutex_t*);
+    int __real_pthread_cond_timedwait(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+    int __real_sem_wait(sem_t*);
+
+    int __real_usleep(useconds_t);
+    int __real_nanosleep(const struct timespec*, struct timespec*);
+    int __real_sched_yield();
+    int __real_open(const char*, int, ...);
+    FILE* __real_fopen(const char*, const char*);
+    ssize_t __real_read(int, void*, size_t);
+    ssize_t __real_write(int, const void*, size_t);
+    void* __real_mmap(void*, size_t, int, int, int, off_t);
+    int __real_munmap(void*, size_t);
+
+    int __real_open64(const char*, int, ...);
+    FILE* __real_fopen64(const char*, const char*);
+    void* __real_mmap64(void*, size_t, int, int, int, off64_t);
+    ssize_t __real___read_chk(int, void*, size_t, size_t);
+    int __real___open_2(const char*, int);
+    int __real___open64_2(const char*, int);
+
+    void* __wrap_malloc(size_t size)                      { recordViolation("malloc"); return __real_malloc(size); }
+    void* __wrap_calloc(size_t count, size_t size)        { recordViolation("calloc"); return __real_calloc(count, size); }
+    void* __wrap_realloc(void* pointer, size_t size)      { recordViolation("realloc"); return __real_realloc(pointer, size); }
+    void* __wrap_aligned_alloc(size_t alignment, size_t size) { recordViolation("aligned_alloc"); return __real_aligned_alloc(alignment, size); }
+
+    int __wrap_posix_memalign(void** pointer, size_t alignment, size_t size)
+    {
+        recordViolation("posix_memalign");
+        return __real_posix_memalign(pointer, alignment, size);
+    }
+
+    void __wrap_free(void* pointer)
+    {
+        if (pointer != nullptr)
+            recordViolation("free");
+
+        __real_free(pointer);
+    }
+
+    int __wrap_pthread_mutex_lock(pthread_mutex_t* mutex) { recordViolation("pthread_mutex_lock"); return __real_pthread_mutex_lock(mutex); }
+    int __wrap_sem_wait(sem_t* semaphore)                 { recordViolation("sem_wait"); return __real_sem_wait(semaphore); }
+
+    int __wrap_pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        recordViolation("pthread_cond_wait");
+        return __real_pthread_cond_wait(condition, mutex);
+    }
+
+    int __wrap_pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        recordViolation("pthread_cond_timedwait");
+        return __real_pthread_cond_timedwait(condition, mutex, time);
+    }
+
+    int __wrap_usleep(useconds_t microseconds)            { recordViolation("usleep"); return __real_usleep(microseconds); }
+    int __wrap_sched_yield()                              { recordViolation("sched_yield"); return __real_sched_yield(); }
+    FILE* __wrap_fopen(const char* path, const char* mode) { recordViolation("fopen"); return __real_fopen(path, mode); }
+    FILE* __wrap_fopen64(const char* path, const char* mode) { recordViolation("fopen64"); return __real_fopen64(path, mode); }
+    ssize_t __wrap_read(int fd, void* data, size_t size)  { recordViolation("read"); return __real_read(fd, data, size); }
+    int __wrap___open_2(const char* path, int flags)      { recordViolation("__open_2"); return __real___open_2(path, flags); }
+    int __wrap___open64_2(const char* path, int flags)    { recordViolation("__open64_2"); return __real___open64_2(path, flags); }
+
+    ssize_t __wrap___read_chk(int fd, void* data, size_t size, size_t bufferSize)
+    {
+        recordViolation("__read_chk");
+        return __real___read_chk(fd, data, size, bufferSize);
+    }
+
+    ssize_t __wrap_write(int fd, const void* data, size_t size) { recordViolation("write"); return __real_write(fd, data, size); }
+    int __wrap_munmap(void* address, size_t size)         { recordViolation("munmap"); return __real_munmap(address, size); }
+
+    int __wrap_nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        recordViolation("nanosleep");
+        return __real_nanosleep(duration, remaining);
+    }
+
+    int __wrap_open(const char* path, int flags, ...)
+    {
+        recordViolation("open");
+
+        mode_t mode = 0;
+
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+
+        return __real_open(path, flags, mode);
+    }
+
+    int __wrap_open64(const char* path, int flags, ...)
+    {
+        recordViolation("open64");
+
+        mode_t mode = 0;
+
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+
+        return __real_open64(path, flags, mode);
+    }
+
+    void* __wrap_mmap(void* address, size_t size, int protection, int flags, int fd, off_t offset)
+    {
+        recordViolation("mmap");
+        return __real_mmap(address, size, protection, flags, fd, offset);
+    }
+
+    void* __wrap_mmap64(void* address, size_t size, int protection, int flags, int fd, off64_t offset)
+    {
+        recordViolation("mmap64");
+        return __real_mmap64(address, size, protection, flags, fd, offset);
+    }
+}
+
+//==============================================================================
+// Replacing the global operators catches allocations from inlined standard library code too
+void* operator new(std::size_t size)
+{
+    recordViolation("operator new");
+
+    if (auto* pointer = __real_malloc(size != 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    recordViolation("operator new[]");
+
+    if (auto* pointer = __real_malloc(size != 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    recordViolation("operator new");
+    return __real_malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    recordViolation("operator new[]");
+    return __real_malloc(size != 0 ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    recordViolation("operator new");
+    void* pointer = nullptr;
+
+    if (__real_posix_memalign(&pointer, (size_t)alignment, size != 0 ? size : 1) == 0)
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    recordViolation("operator new[]");
+    void* pointer = nullptr;
+
+    if (__real_posix_memalign(&pointer, (size_t)alignment, size != 0 ? size : 1) == 0)
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete");
+
+    __real_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete[]");
+
+    __real_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete");
+
+    __real_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete[]");
+
+    __real_free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete");
+
+    __real_free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete[]");
+
+    __real_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete");
+
+    __real_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation("operator delete[]");
+
+    __real_free(pointer);
+}
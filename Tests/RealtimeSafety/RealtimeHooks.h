@@ -0,0 +1,27 @@
+#pragma once
+
+// Link-time hooks (-Wl,--wrap) on allocation, locking and blocking system calls. While a
+// thread is inside a ScopedRealtimeSection every hooked call is recorded with the stack
+// it came from; outside one they pass straight through. Linux only.
+namespace RealtimeHooks
+{
+    // Call once before the first real-time section, so the stack walker is loaded up front
+    void initialise();
+
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+    };
+
+    int getNumViolations();
+
+    // Calls recorded to one hooked function, by the name used in the report
+    int getNumCalls(const char* function);
+
+    // Forgets everything recorded so far
+    void reset();
+
+    // Prints every distinct call site with its count and symbolised stack
+    void printReport();
+}
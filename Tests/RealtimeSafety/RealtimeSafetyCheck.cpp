@@ -0,0 +1,160 @@
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "RealtimeHooks.h"
+
+// Runs processBlock under the real-time hooks with randomised host block sizes (including
+// sizes above the prepared maximum), parameter sweeps and state loads between blocks, and
+// fails if any hooked call is made from inside processBlock.
+// Usage: RetroizerRealtimeSafety [numBlocks] [seed]
+
+namespace
+{
+    juce::File writeImpulseResponse(double sampleRate)
+    {
+        auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("RetroizerRealtimeSafetyIR.wav");
+        juce::AudioBuffer<float> impulse(1, (int)(0.5 * sampleRate));
+        juce::Random random(99);
+
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            impulse.setSample(0, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-8.0f * (float)i / (float)impulse.getNumSamples()));
+
+        file.deleteFile();
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(new juce::FileOutputStream(file), sampleRate, 1, 24, {}, 0));
+
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer(impulse, 0, impulse.getNumSamples());
+
+        return file;
+    }
+
+    int pickBlockSize(juce::Random& random, int preparedBlockSize)
+    {
+        static const int edgeSizes[] = { 1, 2, 3, 63, 64, 65, 127, 128, 129, 4096, 8192 };
+        auto choice = random.nextInt(10);
+
+        if (choice < 6)
+            return 1 + random.nextInt(preparedBlockSize);
+
+        if (choice < 8)
+            return preparedBlockSize + 1 + random.nextInt(3 * preparedBlockSize); // Oversized
+
+        return edgeSizes[random.nextInt((int)std::size(edgeSizes))];
+    }
+
+    bool isFinite(const juce::AudioBuffer<float>& buffer)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                if (! std::isfinite(buffer.getSample(channel, i)))
+                    return false;
+
+        return true;
+    }
+
+    // A clean run only means something if the hooks fire in this binary, so trip two of them
+    // on purpose first. malloc goes through a volatile pointer so the pair can't be elided.
+    bool hooksAreRecording()
+    {
+        void* (*volatile allocate)(size_t) = std::malloc;
+        juce::CriticalSection lock;
+        void* memory = nullptr;
+
+        {
+            RealtimeHooks::ScopedRealtimeSection section;
+            memory = allocate(16);
+            const juce::ScopedLock sl(lock);
+        }
+
+        std::free(memory);
+
+        bool recorded = RealtimeHooks::getNumCalls("malloc") > 0 && RealtimeHooks::getNumCalls("pthread_mutex_lock") > 0;
+        RealtimeHooks::reset();
+        return recorded;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    RealtimeHooks::initialise();
+
+    if (! hooksAreRecording())
+    {
+        std::printf("Self-check failed: a malloc and a mutex lock in a real-time section were not recorded\n");
+        return 1;
+    }
+
+    const int numBlocks = argc > 1 ? juce::String(argv[1]).getIntValue() : 20000;
+    const juce::int64 seed = argc > 2 ? juce::String(argv[2]).getLargeIntValue() : 0x5eed;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int preparedBlockSize = 512;
+    constexpr int maxBlockSize = 8192;
+
+    RetroizerAudioProcessor processor;
+
+    // Run with the sidechain connected so both detector sources are exercised
+    if (auto* sidechain = processor.getBus(true, 1))
+        sidechain->enableBus(true);
+
+    processor.setRateAndBufferSizeDetails(sampleRate, preparedBlockSize);
+    processor.prepareToPlay(sampleRate, preparedBlockSize);
+
+    // States to switch between while running: without an IR, and with one in convolution mode
+    juce::MemoryBlock plainState, convolutionState;
+    processor.getStateInformation(plainState);
+
+    processor.apvts.getParameter(Parameters::idOf(Parameters::ID::radioMode))->setValueNotifyingHost(1.0f);
+    processor.loadRadioImpulseResponse(writeImpulseResponse(sampleRate));
+    processor.getStateInformation(convolutionState);
+
+    const int numChannels = juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+    juce::AudioBuffer<float> storage(numChannels, maxBlockSize);
+    juce::MidiBuffer midi;
+
+    const auto& parameters = processor.getParameters();
+    juce::Random random(seed);
+    int nonFiniteBlocks = 0;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        // One parameter sweeps across its range over 200 blocks, a few others jump at random
+        auto* swept = parameters[(block / 200) % parameters.size()];
+        swept->setValueNotifyingHost((float)(block % 200) / 199.0f);
+
+        for (int i = 0; i < 2; ++i)
+            parameters[random.nextInt(parameters.size())]->setValueNotifyingHost(random.nextFloat());
+
+        if (block % 1000 == 500)
+        {
+            auto& state = (block / 1000) % 2 == 0 ? convolutionState : plainState;
+            processor.setStateInformation(state.getData(), (int)state.getSize());
+        }
+
+        int blockSize = juce::jmin(maxBlockSize, pickBlockSize(random, preparedBlockSize));
+        juce::AudioBuffer<float> buffer(storage.getArrayOfWritePointers(), numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        {
+            RealtimeHooks::ScopedRealtimeSection section;
+            processor.processBlock(buffer, midi);
+        }
+
+        if (! isFinite(buffer))
+            ++nonFiniteBlocks;
+    }
+
+    processor.releaseResources();
+
+    std::printf("%d blocks, seed %lld\n", numBlocks, (long long)seed);
+    RealtimeHooks::printReport();
+
+    if (nonFiniteBlocks > 0)
+        std::printf("%d block(s) produced non-finite output\n", nonFiniteBlocks);
+
+    return RealtimeHooks::getNumViolations() == 0 && nonFiniteBlocks == 0 ? 0 : 1;
+}